@@ -0,0 +1,77 @@
+//
+// Copyright (C) 2019-2021 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "plexe/CC_Const.h"
+
+namespace plexe {
+namespace parameters {
+
+const std::string folmTau = parameter_prefix + "tau_s";
+const std::string folmDt = parameter_prefix + "dt_s";
+const std::string engineVehicle = parameter_prefix + "vehicle";
+const std::string engineXmlFile = parameter_prefix + "xmlFile";
+const std::string engineDt = parameter_prefix + "dt_s";
+const std::string vehicleData = parameter_prefix + "ccvd";
+const std::string vehiclePosition = parameter_prefix + "ccvp";
+const std::string platoonSize = parameter_prefix + "ccps";
+const std::string caccXi = parameter_prefix + "ccxi";
+const std::string caccOmegaN = parameter_prefix + "ccon";
+const std::string caccC1 = parameter_prefix + "ccc1";
+const std::string engineTau = parameter_prefix + "cctau";
+const std::string uMin = parameter_prefix + "ccumin";
+const std::string uMax = parameter_prefix + "ccumax";
+const std::string ploegH = parameter_prefix + "ccph";
+const std::string ploegKp = parameter_prefix + "ccpkp";
+const std::string ploegKd = parameter_prefix + "ccpkd";
+const std::string flatbedKa = parameter_prefix + "ccfka";
+const std::string flatbedKv = parameter_prefix + "ccfkv";
+const std::string flatbedKp = parameter_prefix + "ccfkp";
+const std::string flatbedH = parameter_prefix + "ccfh";
+const std::string flatbedD = parameter_prefix + "ccfd";
+const std::string vehicleEngineModel = parameter_prefix + "ccem";
+const std::string vehicleModel = parameter_prefix + "ccvm";
+const std::string vehiclesFile = parameter_prefix + "ccvf";
+const std::string caccSpacing = parameter_prefix + "ccsp";
+const std::string accAcceleration = parameter_prefix + "ccacc";
+const std::string crashed = parameter_prefix + "cccr";
+const std::string fixedAcceleration = parameter_prefix + "ccfa";
+const std::string speedAndAcceleration = parameter_prefix + "ccsa";
+const std::string leaderSpeedAndAcceleration = parameter_prefix + "cclsa";
+const std::string useControllerAcceleration = parameter_prefix + "ccca";
+const std::string lanesCount = parameter_prefix + "cclc";
+const std::string ccDesiredSpeed = parameter_prefix + "ccds";
+const std::string activeController = parameter_prefix + "ccac";
+const std::string ccInstalled = parameter_prefix + "ccci";
+const std::string radarData = parameter_prefix + "ccrd";
+const std::string leaderFakeData = parameter_prefix + "cclfd";
+const std::string frontFakeData = parameter_prefix + "ccffd";
+const std::string distanceToEnd = parameter_prefix + "ccdte";
+const std::string distanceFromBegin = parameter_prefix + "ccdfb";
+const std::string precedingSpeedAndAcceleration = parameter_prefix + "ccpsa";
+const std::string accHeadwayTime = parameter_prefix + "ccaht";
+const std::string engineData = parameter_prefix + "cced";
+const std::string useAutoFeeding = parameter_prefix + "ccaf";
+const std::string usePrediction = parameter_prefix + "ccup";
+const std::string addMember = parameter_prefix + "ccam";
+const std::string removeMember = parameter_prefix + "ccrm";
+const std::string enableAutoLaneChange = parameter_prefix + "ccalc";
+
+} // namespace parameters
+} // namespace plexe
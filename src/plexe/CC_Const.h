@@ -91,114 +91,171 @@ struct VEHICLE_DATA {
 
 #define MAX_N_CARS 8
 
+/**
+ * Names of the parameters understood by the Plexe models in SUMO. They are
+ * built only once, so the macros below do not create a new string each time
+ * a parameter is set or read
+ */
+namespace parameters {
+extern const std::string folmTau;
+extern const std::string folmDt;
+extern const std::string engineVehicle;
+extern const std::string engineXmlFile;
+extern const std::string engineDt;
+extern const std::string vehicleData;
+extern const std::string vehiclePosition;
+extern const std::string platoonSize;
+extern const std::string caccXi;
+extern const std::string caccOmegaN;
+extern const std::string caccC1;
+extern const std::string engineTau;
+extern const std::string uMin;
+extern const std::string uMax;
+extern const std::string ploegH;
+extern const std::string ploegKp;
+extern const std::string ploegKd;
+extern const std::string flatbedKa;
+extern const std::string flatbedKv;
+extern const std::string flatbedKp;
+extern const std::string flatbedH;
+extern const std::string flatbedD;
+extern const std::string vehicleEngineModel;
+extern const std::string vehicleModel;
+extern const std::string vehiclesFile;
+extern const std::string caccSpacing;
+extern const std::string accAcceleration;
+extern const std::string crashed;
+extern const std::string fixedAcceleration;
+extern const std::string speedAndAcceleration;
+extern const std::string leaderSpeedAndAcceleration;
+extern const std::string useControllerAcceleration;
+extern const std::string lanesCount;
+extern const std::string ccDesiredSpeed;
+extern const std::string activeController;
+extern const std::string ccInstalled;
+extern const std::string radarData;
+extern const std::string leaderFakeData;
+extern const std::string frontFakeData;
+extern const std::string distanceToEnd;
+extern const std::string distanceFromBegin;
+extern const std::string precedingSpeedAndAcceleration;
+extern const std::string accHeadwayTime;
+extern const std::string engineData;
+extern const std::string useAutoFeeding;
+extern const std::string usePrediction;
+extern const std::string addMember;
+extern const std::string removeMember;
+extern const std::string enableAutoLaneChange;
+} // namespace parameters
+
 #define CC_ENGINE_MODEL_FOLM 0x00 // first order lag model
 #define CC_ENGINE_MODEL_REALISTIC 0x01 // the detailed and realistic engine model
 
 // parameter names for engine models
-#define FOLM_PAR_TAU (parameter_prefix + "tau_s")
-#define FOLM_PAR_DT (parameter_prefix + "dt_s")
+#define FOLM_PAR_TAU (plexe::parameters::folmTau)
+#define FOLM_PAR_DT (plexe::parameters::folmDt)
 
-#define ENGINE_PAR_VEHICLE (parameter_prefix + "vehicle")
-#define ENGINE_PAR_XMLFILE (parameter_prefix + "xmlFile")
-#define ENGINE_PAR_DT (parameter_prefix + "dt_s")
+#define ENGINE_PAR_VEHICLE (plexe::parameters::engineVehicle)
+#define ENGINE_PAR_XMLFILE (plexe::parameters::engineXmlFile)
+#define ENGINE_PAR_DT (plexe::parameters::engineDt)
 
-#define CC_PAR_VEHICLE_DATA (parameter_prefix + "ccvd") // data about a vehicle, like position, speed, acceleration, etc
-#define CC_PAR_VEHICLE_POSITION (parameter_prefix + "ccvp") // position of the vehicle in the platoon (0 based)
-#define CC_PAR_PLATOON_SIZE (parameter_prefix + "ccps") // number of cars in the platoon
+#define CC_PAR_VEHICLE_DATA (plexe::parameters::vehicleData) // data about a vehicle, like position, speed, acceleration, etc
+#define CC_PAR_VEHICLE_POSITION (plexe::parameters::vehiclePosition) // position of the vehicle in the platoon (0 based)
+#define CC_PAR_PLATOON_SIZE (plexe::parameters::platoonSize) // number of cars in the platoon
 
 // set of controller-related constants
-#define CC_PAR_CACC_XI (parameter_prefix + "ccxi") // xi
-#define CC_PAR_CACC_OMEGA_N (parameter_prefix + "ccon") // omega_n
-#define CC_PAR_CACC_C1 (parameter_prefix + "ccc1") // C1
-#define CC_PAR_ENGINE_TAU (parameter_prefix + "cctau") // engine time constant
+#define CC_PAR_CACC_XI (plexe::parameters::caccXi) // xi
+#define CC_PAR_CACC_OMEGA_N (plexe::parameters::caccOmegaN) // omega_n
+#define CC_PAR_CACC_C1 (plexe::parameters::caccC1) // C1
+#define CC_PAR_ENGINE_TAU (plexe::parameters::engineTau) // engine time constant
 
-#define CC_PAR_UMIN (parameter_prefix + "ccumin") // lower saturation for u
-#define CC_PAR_UMAX (parameter_prefix + "ccumax") // upper saturation for u
+#define CC_PAR_UMIN (plexe::parameters::uMin) // lower saturation for u
+#define CC_PAR_UMAX (plexe::parameters::uMax) // upper saturation for u
 
-#define CC_PAR_PLOEG_H (parameter_prefix + "ccph") // time headway of ploeg's CACC
-#define CC_PAR_PLOEG_KP (parameter_prefix + "ccpkp") // kp parameter of ploeg's CACC
-#define CC_PAR_PLOEG_KD (parameter_prefix + "ccpkd") // kd parameter of ploeg's CACC
+#define CC_PAR_PLOEG_H (plexe::parameters::ploegH) // time headway of ploeg's CACC
+#define CC_PAR_PLOEG_KP (plexe::parameters::ploegKp) // kp parameter of ploeg's CACC
+#define CC_PAR_PLOEG_KD (plexe::parameters::ploegKd) // kd parameter of ploeg's CACC
 
-#define CC_PAR_FLATBED_KA (parameter_prefix + "ccfka") // ka parameter of flatbed CACC
-#define CC_PAR_FLATBED_KV (parameter_prefix + "ccfkv") // kv parameter of flatbed CACC
-#define CC_PAR_FLATBED_KP (parameter_prefix + "ccfkp") // kp parameter of flatbed CACC
-#define CC_PAR_FLATBED_H (parameter_prefix + "ccfh") // h parameter of flatbed CACC
-#define CC_PAR_FLATBED_D (parameter_prefix + "ccfd") // distance parameter of flatbed CACC
+#define CC_PAR_FLATBED_KA (plexe::parameters::flatbedKa) // ka parameter of flatbed CACC
+#define CC_PAR_FLATBED_KV (plexe::parameters::flatbedKv) // kv parameter of flatbed CACC
+#define CC_PAR_FLATBED_KP (plexe::parameters::flatbedKp) // kp parameter of flatbed CACC
+#define CC_PAR_FLATBED_H (plexe::parameters::flatbedH) // h parameter of flatbed CACC
+#define CC_PAR_FLATBED_D (plexe::parameters::flatbedD) // distance parameter of flatbed CACC
 
-#define CC_PAR_VEHICLE_ENGINE_MODEL (parameter_prefix + "ccem") // set the engine model for a vehicle
+#define CC_PAR_VEHICLE_ENGINE_MODEL (plexe::parameters::vehicleEngineModel) // set the engine model for a vehicle
 
-#define CC_PAR_VEHICLE_MODEL (parameter_prefix + "ccvm") // set the vehicle model, i.e., engine characteristics
-#define CC_PAR_VEHICLES_FILE (parameter_prefix + "ccvf") // set the location of the vehicle parameters file
+#define CC_PAR_VEHICLE_MODEL (plexe::parameters::vehicleModel) // set the vehicle model, i.e., engine characteristics
+#define CC_PAR_VEHICLES_FILE (plexe::parameters::vehiclesFile) // set the location of the vehicle parameters file
 
 // set CACC constant spacing
-#define PAR_CACC_SPACING (parameter_prefix + "ccsp")
+#define PAR_CACC_SPACING (plexe::parameters::caccSpacing)
 
 // get ACC computed acceleration when faked CACC controller is enabled
-#define PAR_ACC_ACCELERATION (parameter_prefix + "ccacc")
+#define PAR_ACC_ACCELERATION (plexe::parameters::accAcceleration)
 
 // determine whether a vehicle has crashed or not
-#define PAR_CRASHED (parameter_prefix + "cccr")
+#define PAR_CRASHED (plexe::parameters::crashed)
 
 // set a fixed acceleration to a vehicle controlled by CC/ACC/CACC
-#define PAR_FIXED_ACCELERATION (parameter_prefix + "ccfa")
+#define PAR_FIXED_ACCELERATION (plexe::parameters::fixedAcceleration)
 
 // get vehicle speed and acceleration, needed for example by the platoon leader (get: vehicle)
-#define PAR_SPEED_AND_ACCELERATION (parameter_prefix + "ccsa")
+#define PAR_SPEED_AND_ACCELERATION (plexe::parameters::speedAndAcceleration)
 
 // set speed and acceleration of the platoon leader
-#define PAR_LEADER_SPEED_AND_ACCELERATION (parameter_prefix + "cclsa")
+#define PAR_LEADER_SPEED_AND_ACCELERATION (plexe::parameters::leaderSpeedAndAcceleration)
 
 // set whether CACCs should use real or controller acceleration
-#define PAR_USE_CONTROLLER_ACCELERATION (parameter_prefix + "ccca")
+#define PAR_USE_CONTROLLER_ACCELERATION (plexe::parameters::useControllerAcceleration)
 
 // get lane count for the street the vehicle is currently traveling
-#define PAR_LANES_COUNT (parameter_prefix + "cclc")
+#define PAR_LANES_COUNT (plexe::parameters::lanesCount)
 
 // set the cruise control desired speed
-#define PAR_CC_DESIRED_SPEED (parameter_prefix + "ccds")
+#define PAR_CC_DESIRED_SPEED (plexe::parameters::ccDesiredSpeed)
 
 // set the currently active vehicle controller which can be either the driver, or the ACC or the CACC
-#define PAR_ACTIVE_CONTROLLER (parameter_prefix + "ccac")
+#define PAR_ACTIVE_CONTROLLER (plexe::parameters::activeController)
 
 // get whether a cruise controller is installed in the car
-#define PAR_CC_INSTALLED (parameter_prefix + "ccci")
+#define PAR_CC_INSTALLED (plexe::parameters::ccInstalled)
 
 // get radar data from the car
-#define PAR_RADAR_DATA (parameter_prefix + "ccrd")
+#define PAR_RADAR_DATA (plexe::parameters::radarData)
 
 // communicate with the cruise control to give him fake indications. this can be useful when you want
 // to advance a vehicle to a certain position, for example, for joining a platoon. clearly the ACC
 // must always take into consideration both fake and real data
-#define PAR_LEADER_FAKE_DATA (parameter_prefix + "cclfd")
-#define PAR_FRONT_FAKE_DATA (parameter_prefix + "ccffd")
+#define PAR_LEADER_FAKE_DATA (plexe::parameters::leaderFakeData)
+#define PAR_FRONT_FAKE_DATA (plexe::parameters::frontFakeData)
 
 // get the distance that a car has to travel until it reaches the end of its route
-#define PAR_DISTANCE_TO_END (parameter_prefix + "ccdte")
+#define PAR_DISTANCE_TO_END (plexe::parameters::distanceToEnd)
 
 // get the distance from the beginning of the route
-#define PAR_DISTANCE_FROM_BEGIN (parameter_prefix + "ccdfb")
+#define PAR_DISTANCE_FROM_BEGIN (plexe::parameters::distanceFromBegin)
 
 // set speed and acceleration of preceding vehicle
-#define PAR_PRECEDING_SPEED_AND_ACCELERATION (parameter_prefix + "ccpsa")
+#define PAR_PRECEDING_SPEED_AND_ACCELERATION (plexe::parameters::precedingSpeedAndAcceleration)
 
 // set ACC headway time
-#define PAR_ACC_HEADWAY_TIME (parameter_prefix + "ccaht")
+#define PAR_ACC_HEADWAY_TIME (plexe::parameters::accHeadwayTime)
 
 // return engine information (for the realistic engine model)
-#define PAR_ENGINE_DATA (parameter_prefix + "cced")
+#define PAR_ENGINE_DATA (plexe::parameters::engineData)
 
 // enabling/disabling auto feeding
-#define PAR_USE_AUTO_FEEDING (parameter_prefix + "ccaf")
+#define PAR_USE_AUTO_FEEDING (plexe::parameters::useAutoFeeding)
 
 // enabling/disabling data prediction
-#define PAR_USE_PREDICTION (parameter_prefix + "ccup")
+#define PAR_USE_PREDICTION (plexe::parameters::usePrediction)
 
 // add/remove members from own platoon
-#define PAR_ADD_MEMBER (parameter_prefix + "ccam")
-#define PAR_REMOVE_MEMBER (parameter_prefix + "ccrm")
+#define PAR_ADD_MEMBER (plexe::parameters::addMember)
+#define PAR_REMOVE_MEMBER (plexe::parameters::removeMember)
 
 // let the leader automatically change lane for the whole platoon if there is a speed advantage
-#define PAR_ENABLE_AUTO_LANE_CHANGE (parameter_prefix + "ccalc")
+#define PAR_ENABLE_AUTO_LANE_CHANGE (plexe::parameters::enableAutoLaneChange)
 
 } // namespace plexe
 
@@ -22,12 +22,26 @@
 
 #include "plexe/mobility/CommandInterface.h"
 
+#include <cctype>
+
 namespace plexe {
 
 Define_Module(PlexeManager);
 
+PlexeManager::~PlexeManager()
+{
+    cancelAndDelete(statisticsMsg);
+}
+
 void PlexeManager::initialize(int stage)
 {
+    collectStatistics = par("collectStatistics").boolValue();
+    statisticsInterval = par("statisticsInterval").doubleValue();
+    if (collectStatistics && statisticsInterval > 0) {
+        statisticsMsg = new cMessage("statisticsMsg");
+        scheduleAt(simTime() + statisticsInterval, statisticsMsg);
+    }
+
     const auto scenarioManager = veins::TraCIScenarioManagerAccess().get();
     ASSERT(scenarioManager);
 
@@ -44,10 +58,48 @@ void PlexeManager::initializeCommandInterface()
 {
     const auto scenarioManager = veins::TraCIScenarioManagerAccess().get();
     ASSERT(scenarioManager);
-    commandInterface.reset(new traci::CommandInterface(this, scenarioManager->getCommandInterface(), scenarioManager->getConnection()));
+    commandInterface.reset(new traci::CommandInterface(this, scenarioManager->getCommandInterface(), scenarioManager->getConnection(), par("batchCommands").boolValue()));
+    commandInterface->setCollectStatistics(collectStatistics);
 
     auto timestep = [this](veins::SignalPayload<simtime_t const&>) { commandInterface->executePlexeTimestep(); };
     signalManager.subscribeCallback(scenarioManager, veins::TraCIScenarioManager::traciTimestepEndSignal, timestep);
+
+    // vehicle states are only valid until sumo advances
+    auto invalidate = [this](veins::SignalPayload<simtime_t const&>) { commandInterface->invalidateVehicleStates(); };
+    signalManager.subscribeCallback(scenarioManager, veins::TraCIScenarioManager::traciTimestepBeginSignal, invalidate);
+
+    if (commandInterface->isBatching()) {
+        // send the commands queued since the last step right before asking
+        // SUMO to advance, so that they are applied in the upcoming step
+        auto flush = [this](veins::SignalPayload<simtime_t const&>) { commandInterface->flushCommands(); };
+        signalManager.subscribeCallback(scenarioManager, veins::TraCIScenarioManager::traciTimestepBeginSignal, flush);
+    }
+}
+
+void PlexeManager::handleMessage(cMessage* msg)
+{
+    if (msg == statisticsMsg) {
+        if (commandInterface) commandInterface->logStatistics();
+        scheduleAt(simTime() + statisticsInterval, statisticsMsg);
+    }
+}
+
+void PlexeManager::finish()
+{
+    if (collectStatistics && commandInterface) commandInterface->recordStatistics(this);
+
+    for (const auto& summary : globalSummaries) {
+        std::string name = "global" + summary.first;
+        name[6] = toupper(name[6]);
+        const LogLinearHistogram& histogram = summary.second;
+        recordScalar((name + "Count").c_str(), histogram.getCount());
+        if (histogram.getCount() == 0) continue;
+        recordScalar((name + "Mean").c_str(), histogram.getMean());
+        recordScalar((name + "P50").c_str(), histogram.getQuantile(0.5));
+        recordScalar((name + "P95").c_str(), histogram.getQuantile(0.95));
+        recordScalar((name + "P99").c_str(), histogram.getQuantile(0.99));
+        recordScalar((name + "Max").c_str(), histogram.getMax());
+    }
 }
 
 } // namespace plexe
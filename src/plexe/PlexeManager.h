@@ -27,12 +27,23 @@
 #include <veins/modules/utility/SignalManager.h>
 
 #include <plexe/mobility/CommandInterface.h>
+#include <plexe/utilities/LogLinearHistogram.h>
+
+#include <map>
+#include <string>
 
 namespace plexe {
 
 class PlexeManager : public cSimpleModule {
 public:
+    PlexeManager()
+        : statisticsMsg(nullptr)
+    {
+    }
+    ~PlexeManager();
+
     void initialize(int stage) override;
+    void finish() override;
 
     /**
      * Return a weak pointer to the CommandInterface owned by this manager.
@@ -42,11 +53,33 @@ public:
         return commandInterface.get();
     }
 
+    /**
+     * Returns the summary of a metric over all vehicles, to which protocols
+     * add their values as they collect them. It is recorded at the end of
+     * the simulation, as scalars named after the metric with a "global"
+     * prefix (e.g., globalLeaderDelayP95 for leaderDelay)
+     */
+    LogLinearHistogram& getGlobalSummary(const std::string& name)
+    {
+        return globalSummaries[name];
+    }
+
+protected:
+    void handleMessage(cMessage* msg) override;
+
 private:
     void initializeCommandInterface();
 
     std::unique_ptr<traci::CommandInterface> commandInterface;
     veins::SignalManager signalManager;
+
+    // statistics about the usage of the TraCI API
+    bool collectStatistics;
+    simtime_t statisticsInterval;
+    cMessage* statisticsMsg;
+
+    // summaries of protocol metrics over all vehicles, by metric name
+    std::map<std::string, LogLinearHistogram> globalSummaries;
 };
 
 } // namespace plexe
@@ -27,6 +27,10 @@
 
 #include "plexe/protocols/BaseProtocol.h"
 #include "plexe/PlexeManager.h"
+#include "plexe/utilities/DeadReckoning.h"
+
+#include <algorithm>
+#include <cmath>
 
 using namespace veins;
 
@@ -55,6 +59,14 @@ void BaseApp::initialize(int stage)
         // vehicle acceleration
         accelerationOut.setName("acceleration");
         controllerAccelerationOut.setName("controllerAcceleration");
+
+        predictMissingBeacons = par("predictMissingBeacons");
+        predictionInterval = SimTime(par("predictionInterval").doubleValue());
+        maxPredictionTime = SimTime(par("maxPredictionTime").doubleValue());
+        predictWithControllerAcceleration = par("predictWithControllerAcceleration");
+        // prediction error w.r.t. the data received in the next beacon
+        predictionSpeedErrorOut.setName("predictionSpeedError");
+        predictionDistanceErrorOut.setName("predictionDistanceError");
     }
 
     if (stage == 1) {
@@ -70,12 +82,18 @@ void BaseApp::initialize(int stage)
         myId = positionHelper->getId();
 
         // connect application to protocol
-        protocol->registerApplication(BaseProtocol::BEACON_TYPE, gate("lowerLayerIn"), gate("lowerLayerOut"), gate("lowerControlIn"), gate("lowerControlOut"));
+        protocol->registerApplication(BaseProtocol::BEACON_TYPE, gate("lowerLayerIn"), gate("lowerLayerOut"), gate("lowerControlIn"), gate("lowerControlOut"), this);
+        protocol->registerApplication(BaseProtocol::AGGREGATED_BEACON_TYPE, gate("lowerLayerIn"), gate("lowerLayerOut"), gate("lowerControlIn"), gate("lowerControlOut"), this);
 
         recordData = new cMessage("recordData");
         // init statistics collection. round to 0.1 seconds
         SimTime rounded = SimTime(floor(simTime().dbl() * 1000 + 100), SIMTIME_MS);
         scheduleAt(rounded, recordData);
+
+        if (predictMissingBeacons) {
+            predictData = new cMessage("predictData");
+            scheduleAt(simTime() + predictionInterval, predictData);
+        }
     }
 }
 
@@ -85,6 +103,8 @@ BaseApp::~BaseApp()
     recordData = nullptr;
     cancelAndDelete(stopSimulation);
     stopSimulation = nullptr;
+    cancelAndDelete(predictData);
+    predictData = nullptr;
 }
 
 void BaseApp::handleLowerMsg(cMessage* msg)
@@ -97,13 +117,35 @@ void BaseApp::handleLowerMsg(cMessage* msg)
     if (enc->getKind() == BaseProtocol::BEACON_TYPE) {
         onPlatoonBeacon(check_and_cast<PlatooningBeacon*>(enc));
     }
+    else if (enc->getKind() == BaseProtocol::AGGREGATED_BEACON_TYPE) {
+        onAggregatedBeacon(check_and_cast<AggregatedBeacon*>(enc));
+    }
     else {
         error("received unknown message type");
     }
 
+    delete enc;
     delete frame;
 }
 
+void BaseApp::onFrameReceived(const BaseFrame1609_4* frame)
+{
+    Enter_Method_Silent();
+
+    cPacket* enc = frame->getEncapsulatedPacket();
+    ASSERT2(enc, "received a BaseFrame1609_4 with nothing inside");
+
+    if (enc->getKind() == BaseProtocol::BEACON_TYPE) {
+        onPlatoonBeacon(check_and_cast<const PlatooningBeacon*>(enc));
+    }
+    else if (enc->getKind() == BaseProtocol::AGGREGATED_BEACON_TYPE) {
+        onAggregatedBeacon(check_and_cast<const AggregatedBeacon*>(enc));
+    }
+    else {
+        error("received unknown message type");
+    }
+}
+
 void BaseApp::logVehicleData(bool crashed)
 {
     // get distance and relative speed w.r.t. front vehicle
@@ -151,17 +193,62 @@ void BaseApp::handleSelfMsg(cMessage* msg)
     if (msg == stopSimulation) {
         endSimulation();
     }
+    if (msg == predictData) {
+        VEHICLE_DATA predicted;
+        if (predict(predictedLeader, positionHelper->getLeaderId(), predicted)) {
+            plexeTraciVehicle->setLeaderVehicleData(predicted.u, predicted.acceleration, predicted.speed, predicted.positionX, predicted.positionY, predicted.time);
+        }
+        if (predict(predictedFront, positionHelper->getFrontId(), predicted)) {
+            plexeTraciVehicle->setFrontVehicleData(predicted.u, predicted.acceleration, predicted.speed, predicted.positionX, predicted.positionY, predicted.time);
+        }
+        scheduleAt(simTime() + predictionInterval, predictData);
+    }
+}
+
+void BaseApp::updatePrediction(PredictedVehicle& vehicle, const PlatooningBeacon* pb)
+{
+    if (vehicle.vehicleId == pb->getVehicleId() && pb->getTime() > vehicle.data.time) {
+        VEHICLE_DATA predicted;
+        extrapolateVehicleData(vehicle.data, pb->getTime(), predictWithControllerAcceleration ? vehicle.data.u : vehicle.data.acceleration, predicted);
+        predictionSpeedErrorOut.record(predicted.speed - pb->getSpeed());
+        predictionDistanceErrorOut.record(std::hypot(predicted.positionX - pb->getPositionX(), predicted.positionY - pb->getPositionY()));
+    }
+    vehicle.vehicleId = pb->getVehicleId();
+    vehicle.data.speed = pb->getSpeed();
+    vehicle.data.acceleration = pb->getAcceleration();
+    vehicle.data.u = pb->getControllerAcceleration();
+    vehicle.data.positionX = pb->getPositionX();
+    vehicle.data.positionY = pb->getPositionY();
+    vehicle.data.time = pb->getTime();
+    vehicle.data.length = pb->getLength();
+    vehicle.data.speedX = pb->getSpeedX();
+    vehicle.data.speedY = pb->getSpeedY();
+    vehicle.data.angle = pb->getAngle();
+}
+
+bool BaseApp::predict(const PredictedVehicle& vehicle, int vehicleId, VEHICLE_DATA& predicted)
+{
+    if (vehicle.vehicleId != vehicleId) return false;
+    SimTime age = simTime() - vehicle.data.time;
+    // fresh data is already in the controller
+    if (age < predictionInterval || age > maxPredictionTime) return false;
+    extrapolateVehicleData(vehicle.data, simTime().dbl(), predictWithControllerAcceleration ? vehicle.data.u : vehicle.data.acceleration, predicted);
+    return true;
 }
 
 void BaseApp::onPlatoonBeacon(const PlatooningBeacon* pb)
 {
+    double& lastTime = lastBeaconTime[pb->getVehicleId()];
+    lastTime = std::max(lastTime, pb->getTime());
     if (positionHelper->isInSamePlatoon(pb->getVehicleId())) {
         // if the message comes from the leader
         if (pb->getVehicleId() == positionHelper->getLeaderId()) {
+            if (predictMissingBeacons) updatePrediction(predictedLeader, pb);
             plexeTraciVehicle->setLeaderVehicleData(pb->getControllerAcceleration(), pb->getAcceleration(), pb->getSpeed(), pb->getPositionX(), pb->getPositionY(), pb->getTime());
         }
         // if the message comes from the vehicle in front
         if (pb->getVehicleId() == positionHelper->getFrontId()) {
+            if (predictMissingBeacons) updatePrediction(predictedFront, pb);
             plexeTraciVehicle->setFrontVehicleData(pb->getControllerAcceleration(), pb->getAcceleration(), pb->getSpeed(), pb->getPositionX(), pb->getPositionY(), pb->getTime());
         }
         // send data about every vehicle to the CACC. this is needed by the consensus controller
@@ -180,7 +267,31 @@ void BaseApp::onPlatoonBeacon(const PlatooningBeacon* pb)
         // send information to CACC
         plexeTraciVehicle->setVehicleData(&vehicleData);
     }
-    delete pb;
+}
+
+void BaseApp::onAggregatedBeacon(const AggregatedBeacon* ab)
+{
+    for (size_t i = 0; i < ab->getMembersArraySize(); i++) {
+        const MemberState& member = ab->getMembers(i);
+        // we know our own state better than the aggregator
+        if (member.vehicleId == myId) continue;
+        // skip states that are older than what we already know, e.g., the
+        // aggregator has not heard from the member since its last direct beacon
+        auto last = lastBeaconTime.find(member.vehicleId);
+        if (last != lastBeaconTime.end() && member.time <= last->second) continue;
+        memberBeacon.setVehicleId(member.vehicleId);
+        memberBeacon.setControllerAcceleration(member.controllerAcceleration);
+        memberBeacon.setAcceleration(member.acceleration);
+        memberBeacon.setSpeed(member.speed);
+        memberBeacon.setPositionX(member.positionX);
+        memberBeacon.setPositionY(member.positionY);
+        memberBeacon.setTime(member.time);
+        memberBeacon.setLength(member.length);
+        memberBeacon.setSpeedX(member.speedX);
+        memberBeacon.setSpeedY(member.speedY);
+        memberBeacon.setAngle(member.angle);
+        onPlatoonBeacon(&memberBeacon);
+    }
 }
 
 } // namespace plexe
@@ -21,19 +21,21 @@
 #ifndef BASEAPP_H_
 #define BASEAPP_H_
 
+#include <map>
+
 #include "veins/base/modules/BaseApplLayer.h"
 #include "veins/modules/mobility/traci/TraCIMobility.h"
 
 #include "plexe/CC_Const.h"
+#include "plexe/messages/AggregatedBeacon_m.h"
 #include "plexe/messages/PlatooningBeacon_m.h"
 #include "plexe/mobility/CommandInterface.h"
 #include "plexe/utilities/BasePositionHelper.h"
+#include "plexe/protocols/BaseProtocol.h"
 
 namespace plexe {
 
-class BaseProtocol;
-
-class BaseApp : public veins::BaseApplLayer {
+class BaseApp : public veins::BaseApplLayer, public FrameListener {
 
 public:
     virtual void initialize(int stage) override;
@@ -74,11 +76,44 @@ protected:
     // message to stop the simulation in case of collision
     cMessage* stopSimulation;
 
+    // last data received from a vehicle the controller needs, which is
+    // extrapolated when beacons are missing
+    struct PredictedVehicle {
+        int vehicleId = -1;
+        VEHICLE_DATA data;
+    };
+    PredictedVehicle predictedLeader, predictedFront;
+    // whether to extrapolate leader and front data between beacons
+    bool predictMissingBeacons;
+    // interval at which extrapolated data is given to the controller
+    SimTime predictionInterval;
+    // time after the last beacon at which extrapolation stops
+    SimTime maxPredictionTime;
+    // use the controller acceleration rather than the actual one
+    bool predictWithControllerAcceleration;
+    // message to periodically give extrapolated data to the controller
+    cMessage* predictData;
+    // error between extrapolated and received data
+    cOutVector predictionSpeedErrorOut, predictionDistanceErrorOut;
+
+    /**
+     * Stores the data of a beacon for extrapolation, recording the error
+     * of the extrapolation up to the time of the beacon
+     */
+    void updatePrediction(PredictedVehicle& vehicle, const PlatooningBeacon* pb);
+
+    /**
+     * Extrapolates the data of a vehicle to the current time. Returns
+     * false if the data is recent enough or too old to be extrapolated
+     */
+    bool predict(const PredictedVehicle& vehicle, int vehicleId, VEHICLE_DATA& predicted);
+
 public:
     BaseApp()
     {
         recordData = 0;
         stopSimulation = nullptr;
+        predictData = nullptr;
     }
     virtual ~BaseApp();
 
@@ -90,15 +125,35 @@ public:
      */
     void sendFrame(cPacket* msg, int destination);
 
+    /**
+     * Handles beacons delivered directly by the protocol, when it is
+     * configured to do so. The frame is not owned by the application
+     */
+    virtual void onFrameReceived(const BaseFrame1609_4* frame) override;
+
 protected:
     virtual void handleLowerMsg(cMessage* msg) override;
     virtual void handleSelfMsg(cMessage* msg) override;
     virtual void handleLowerControl(cMessage* msg) override;
 
     /**
-     * Handles PlatoonBeacons
+     * Handles PlatoonBeacons. The beacon must only be read, as it might be
+     * shared with other applications. Freeing it is a duty of the caller
      */
     virtual void onPlatoonBeacon(const PlatooningBeacon* pb);
+
+    /**
+     * Handles AggregatedBeacons, passing the state of each member to
+     * onPlatoonBeacon() as if it was received in a beacon of its own.
+     * Member states that are not newer than the last state fed for the
+     * same vehicle (either directly or relayed) are skipped
+     */
+    virtual void onAggregatedBeacon(const AggregatedBeacon* ab);
+
+    // beacon used to unpack the members of aggregated beacons
+    PlatooningBeacon memberBeacon;
+    // timestamp of the last state fed to onPlatoonBeacon() for each vehicle id
+    std::map<int, double> lastBeaconTime;
 };
 
 } // namespace plexe
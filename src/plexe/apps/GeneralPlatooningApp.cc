@@ -36,6 +36,20 @@ namespace plexe {
 
 Define_Module(GeneralPlatooningApp);
 
+namespace {
+
+// number of group messages remembered per sender to discard retransmissions
+const size_t maxTrackedGroupMessages = 64;
+
+void setRecipients(ManeuverMessage* msg, const std::set<int>& recipients)
+{
+    msg->setRecipientsArraySize(recipients.size());
+    int i = 0;
+    for (int recipient : recipients) msg->setRecipients(i++, recipient);
+}
+
+} // namespace
+
 void GeneralPlatooningApp::initialize(int stage)
 {
     BaseApp::initialize(stage);
@@ -46,6 +60,9 @@ void GeneralPlatooningApp::initialize(int stage)
         // register to the signal indicating failed unicast transmissions
         findHost()->subscribe(Mac1609_4::sigRetriesExceeded, this);
 
+        // maneuvers register their timers when constructed
+        timerService = new TimerService(this, par("timerResolution").doubleValue(), par("timerWheelSlots").intValue());
+
         std::string joinManeuverName = par("joinManeuver").stdstringValue();
         if (joinManeuverName == "JoinAtBack")
             joinManeuver = new JoinAtBack(this);
@@ -58,20 +75,39 @@ void GeneralPlatooningApp::initialize(int stage)
         else
             throw new cRuntimeError("Invalid merge maneuver implementation chosen");
 
+        maneuverManager.addManeuver(joinManeuver);
+        maneuverManager.addManeuver(mergeManeuver);
+        maneuverManager.parseConflicts(par("maneuverConflicts").stdstringValue());
+
         scenario = FindModule<BaseScenario*>::findSubModule(getParentModule());
+
+        groupSend = par("groupSend").boolValue();
+        groupAckTimeout = par("groupAckTimeout").doubleValue();
+        groupMaxRetransmissions = par("groupMaxRetransmissions").intValue();
+        groupAckDelay = par("groupAckDelay").doubleValue();
+        groupAckTimer = timerService->registerTimer("groupAck", [this]() { sendGroupAcks(); });
+        groupRetransmissionTimer = timerService->registerTimer("groupRetransmission", [this]() { retransmitGroupMessages(); });
     }
 }
 
+void GeneralPlatooningApp::finish()
+{
+    if (timerService) timerService->recordStatistics();
+    BaseApp::finish();
+}
+
 void GeneralPlatooningApp::handleSelfMsg(cMessage* msg)
 {
-    if (joinManeuver && joinManeuver->handleSelfMsg(msg)) return;
-    if (mergeManeuver && mergeManeuver->handleSelfMsg(msg)) return;
+    if (timerService->handleMessage(msg)) return;
+    for (Maneuver* maneuver : maneuverManager.getManeuvers())
+        if (maneuver->handleSelfMsg(msg)) return;
     BaseApp::handleSelfMsg(msg);
 }
 
 bool GeneralPlatooningApp::isJoinAllowed() const
 {
-    return ((role == PlatoonRole::LEADER || role == PlatoonRole::NONE) && !inManeuver);
+    if (role != PlatoonRole::LEADER && role != PlatoonRole::NONE) return false;
+    return maneuverManager.canLock(nullptr, JoinAtBack::leaderExclusiveResources, ManeuverManager::LockMode::EXCLUSIVE) && maneuverManager.canLock(nullptr, JoinAtBack::leaderSharedResources, ManeuverManager::LockMode::SHARED);
 }
 
 enum ACTIVE_CONTROLLER GeneralPlatooningApp::getController()
@@ -87,7 +123,6 @@ double GeneralPlatooningApp::getTargetDistance(double speed)
 void GeneralPlatooningApp::startJoinManeuver(int platoonId, int leaderId, int position)
 {
     ASSERT(getPlatoonRole() == PlatoonRole::NONE);
-    ASSERT(!isInManeuver());
 
     JoinManeuverParameters params;
     params.platoonId = platoonId;
@@ -99,7 +134,6 @@ void GeneralPlatooningApp::startJoinManeuver(int platoonId, int leaderId, int po
 void GeneralPlatooningApp::startMergeManeuver(int platoonId, int leaderId, int position)
 {
     ASSERT(getPlatoonRole() == PlatoonRole::LEADER);
-    ASSERT(!isInManeuver());
 
     JoinManeuverParameters params;
     params.platoonId = platoonId;
@@ -111,9 +145,47 @@ void GeneralPlatooningApp::startMergeManeuver(int platoonId, int leaderId, int p
 void GeneralPlatooningApp::sendUnicast(cPacket* msg, int destination)
 {
     Enter_Method_Silent();
+    sendFrame(msg, destination);
+}
+
+void GeneralPlatooningApp::sendToGroup(ManeuverMessage* msg, const std::vector<int>& destinations)
+{
+    Enter_Method_Silent();
+    take(msg);
+    if (!groupSend) {
+        for (int destination : destinations) {
+            ManeuverMessage* copy = msg->dup();
+            copy->setDestinationId(destination);
+            sendFrame(copy, destination);
+        }
+        delete msg;
+        return;
+    }
+    if (destinations.empty()) {
+        delete msg;
+        return;
+    }
+
+    msg->setDestinationId(-1);
+    msg->setGroupSequenceNumber(groupSequenceNumber++);
+    PendingGroupMessage& pending = pendingGroupMessages[msg->getGroupSequenceNumber()];
+    pending.msg = msg;
+    pending.missing.insert(destinations.begin(), destinations.end());
+    pending.retransmissions = 0;
+    pending.deadline = simTime() + groupAckTimeout;
+
+    ManeuverMessage* copy = msg->dup();
+    setRecipients(copy, pending.missing);
+    sendFrame(copy, -1);
+    // pending messages expire in the order they are sent, so an armed timer already expires earlier
+    if (!timerService->isArmed(groupRetransmissionTimer)) timerService->arm(groupRetransmissionTimer, groupAckTimeout);
+}
+
+void GeneralPlatooningApp::sendFrame(cPacket* msg, int destination)
+{
     take(msg);
     BaseFrame1609_4* frame = new BaseFrame1609_4("BaseFrame1609_4", msg->getKind());
-    frame->setRecipientAddress(destination);
+    frame->setRecipientAddress(destination < 0 ? LAddress::L2BROADCAST() : destination);
     frame->setChannelNumber(static_cast<int>(Channel::cch));
     frame->encapsulate(msg);
     // send unicast frames using 11p only
@@ -132,16 +204,27 @@ void GeneralPlatooningApp::handleLowerMsg(cMessage* msg)
 
     if (enc->getKind() == MANEUVER_TYPE) {
         ManeuverMessage* mm = check_and_cast<ManeuverMessage*>(frame->decapsulate());
-        if (UpdatePlatoonData* msg = dynamic_cast<UpdatePlatoonData*>(mm)) {
-            handleUpdatePlatoonData(msg);
-            delete msg;
+        if (!receiveGroupMessage(mm)) {
+            delete mm;
+            delete frame;
+            return;
         }
-        else if (UpdatePlatoonFormation* msg = dynamic_cast<UpdatePlatoonFormation*>(mm)) {
-            handleUpdatePlatoonFormation(msg);
-            delete msg;
-        }
-        else {
+        switch (mm->getMessageType()) {
+        case UPDATE_PLATOON_DATA:
+            handleUpdatePlatoonData(static_cast<UpdatePlatoonData*>(mm));
+            delete mm;
+            break;
+        case UPDATE_PLATOON_FORMATION:
+            handleUpdatePlatoonFormation(static_cast<UpdatePlatoonFormation*>(mm));
+            delete mm;
+            break;
+        case GROUP_ACK:
+            handleGroupAck(static_cast<GroupAck*>(mm));
+            delete mm;
+            break;
+        default:
             onManeuverMessage(mm);
+            break;
         }
         delete frame;
     }
@@ -150,6 +233,88 @@ void GeneralPlatooningApp::handleLowerMsg(cMessage* msg)
     }
 }
 
+bool GeneralPlatooningApp::receiveGroupMessage(const ManeuverMessage* mm)
+{
+    if (mm->getGroupSequenceNumber() < 0) return true;
+
+    bool recipient = false;
+    for (unsigned int i = 0; i < mm->getRecipientsArraySize() && !recipient; i++) recipient = mm->getRecipients(i) == positionHelper->getId();
+    if (!recipient) return false;
+
+    // acknowledge duplicates as well, as they are sent when an acknowledgement is lost
+    std::pair<int, int> ack(mm->getVehicleId(), mm->getGroupSequenceNumber());
+    if (std::find(pendingGroupAcks.begin(), pendingGroupAcks.end(), ack) == pendingGroupAcks.end()) pendingGroupAcks.push_back(ack);
+    if (!timerService->isArmed(groupAckTimer)) timerService->arm(groupAckTimer, groupAckDelay);
+
+    std::set<int>& received = receivedGroupMessages[mm->getVehicleId()];
+    if (!received.insert(mm->getGroupSequenceNumber()).second) return false;
+    if (received.size() > maxTrackedGroupMessages) received.erase(received.begin());
+    return true;
+}
+
+void GeneralPlatooningApp::handleGroupAck(const GroupAck* msg)
+{
+    for (unsigned int i = 0; i < msg->getAckedSenderArraySize(); i++) {
+        if (msg->getAckedSender(i) != positionHelper->getId()) continue;
+        auto pending = pendingGroupMessages.find(msg->getAckedSequenceNumber(i));
+        if (pending == pendingGroupMessages.end()) continue;
+        pending->second.missing.erase(msg->getVehicleId());
+        if (pending->second.missing.empty()) {
+            delete pending->second.msg;
+            pendingGroupMessages.erase(pending);
+        }
+    }
+    if (pendingGroupMessages.empty()) timerService->cancel(groupRetransmissionTimer);
+}
+
+void GeneralPlatooningApp::sendGroupAcks()
+{
+    GroupAck* ack = new GroupAck("GroupAck");
+    fillManeuverMessage(ack, positionHelper->getId(), positionHelper->getExternalId(), positionHelper->getPlatoonId(), -1);
+    ack->setAckedSenderArraySize(pendingGroupAcks.size());
+    ack->setAckedSequenceNumberArraySize(pendingGroupAcks.size());
+    for (unsigned int i = 0; i < pendingGroupAcks.size(); i++) {
+        ack->setAckedSender(i, pendingGroupAcks[i].first);
+        ack->setAckedSequenceNumber(i, pendingGroupAcks[i].second);
+    }
+    pendingGroupAcks.clear();
+    sendFrame(ack, -1);
+}
+
+void GeneralPlatooningApp::retransmitGroupMessages()
+{
+    std::vector<int> failed;
+    for (auto& entry : pendingGroupMessages) {
+        PendingGroupMessage& pending = entry.second;
+        if (pending.deadline > simTime()) continue;
+        if (pending.retransmissions < groupMaxRetransmissions) {
+            // retransmit to the recipients that did not acknowledge
+            pending.retransmissions++;
+            pending.deadline = simTime() + groupAckTimeout;
+            ManeuverMessage* copy = pending.msg->dup();
+            setRecipients(copy, pending.missing);
+            sendFrame(copy, -1);
+        }
+        else {
+            failed.push_back(entry.first);
+        }
+    }
+    for (int sequenceNumber : failed) {
+        auto pending = pendingGroupMessages.find(sequenceNumber);
+        ManeuverMessage* msg = pending->second.msg;
+        // tell the maneuvers which recipients did not acknowledge the message
+        setRecipients(msg, pending->second.missing);
+        pendingGroupMessages.erase(pending);
+        onFailedTransmissionAttempt(msg);
+        delete msg;
+    }
+
+    if (pendingGroupMessages.empty()) return;
+    simtime_t next = pendingGroupMessages.begin()->second.deadline;
+    for (auto& entry : pendingGroupMessages) next = std::min(next, entry.second.deadline);
+    timerService->arm(groupRetransmissionTimer, next - simTime());
+}
+
 void GeneralPlatooningApp::handleUpdatePlatoonData(const UpdatePlatoonData* msg)
 {
     if (getPlatoonRole() != PlatoonRole::FOLLOWER) return;
@@ -185,21 +350,18 @@ void GeneralPlatooningApp::setPlatoonRole(PlatoonRole r)
 
 void GeneralPlatooningApp::onPlatoonBeacon(const PlatooningBeacon* pb)
 {
-    joinManeuver->onPlatoonBeacon(pb);
-    mergeManeuver->onPlatoonBeacon(pb);
+    for (Maneuver* maneuver : maneuverManager.getManeuvers()) maneuver->onPlatoonBeacon(pb);
     // maintain platoon
     BaseApp::onPlatoonBeacon(pb);
 }
 
 void GeneralPlatooningApp::onManeuverMessage(ManeuverMessage* mm)
 {
-    if (activeManeuver) {
-        activeManeuver->onManeuverMessage(mm);
-    }
-    else {
-        joinManeuver->onManeuverMessage(mm);
-        mergeManeuver->onManeuverMessage(mm);
-    }
+    // every maneuver gets the message, whether it is active or not. handlers
+    // check role, phase, and sender before acting, and the lane change only
+    // aborts on unexpected messages if it is in progress. the exception is
+    // a WarnLaneChange, which an idle follower refuses by aborting
+    for (Maneuver* maneuver : maneuverManager.getManeuvers()) maneuver->onManeuverMessage(mm);
     delete mm;
 }
 
@@ -244,13 +406,15 @@ void GeneralPlatooningApp::receiveSignal(cComponent* src, simsignal_t id, cObjec
     if (id == Mac1609_4::sigRetriesExceeded) {
         BaseFrame1609_4* frame = check_and_cast<BaseFrame1609_4*>(value);
         ManeuverMessage* mm = check_and_cast<ManeuverMessage*>(frame->getEncapsulatedPacket());
-        if (frame) {
-            joinManeuver->onFailedTransmissionAttempt(mm);
-            mergeManeuver->onFailedTransmissionAttempt(mm);
-        }
+        if (frame) onFailedTransmissionAttempt(mm);
     }
 }
 
+void GeneralPlatooningApp::onFailedTransmissionAttempt(const ManeuverMessage* mm)
+{
+    for (Maneuver* maneuver : maneuverManager.getManeuvers()) maneuver->onFailedTransmissionAttempt(mm);
+}
+
 void GeneralPlatooningApp::scheduleSelfMsg(simtime_t t, cMessage* msg)
 {
     scheduleAt(t, msg);
@@ -258,8 +422,10 @@ void GeneralPlatooningApp::scheduleSelfMsg(simtime_t t, cMessage* msg)
 
 GeneralPlatooningApp::~GeneralPlatooningApp()
 {
+    for (auto& entry : pendingGroupMessages) delete entry.second.msg;
     delete joinManeuver;
     delete mergeManeuver;
+    delete timerService;
 }
 
 } // namespace plexe
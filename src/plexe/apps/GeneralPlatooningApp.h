@@ -23,17 +23,22 @@
 #define GENERALPLATOONAPP_H_
 
 #include <algorithm>
+#include <map>
 #include <memory>
+#include <set>
 
 #include "plexe/apps/BaseApp.h"
 #include "plexe/maneuver/JoinManeuver.h"
 #include "plexe/maneuver/JoinAtBack.h"
 #include "plexe/maneuver/MergeAtBack.h"
+#include "plexe/maneuver/ManeuverManager.h"
 
 #include "plexe/messages/ManeuverMessage_m.h"
 #include "plexe/messages/UpdatePlatoonData_m.h"
+#include "plexe/messages/GroupAck_m.h"
 
 #include "plexe/scenarios/BaseScenario.h"
+#include "plexe/utilities/TimerService.h"
 
 #include "veins/modules/mobility/traci/TraCIConstants.h"
 #include "veins/modules/utility/SignalManager.h"
@@ -68,12 +73,15 @@ class GeneralPlatooningApp : public BaseApp {
 public:
     /** c'tor for GeneralPlatooningApp */
     GeneralPlatooningApp()
-        : inManeuver(false)
-        , activeManeuver(nullptr)
-        , scenario(nullptr)
+        : scenario(nullptr)
         , role(PlatoonRole::NONE)
         , joinManeuver(nullptr)
         , mergeManeuver(nullptr)
+        , groupSend(false)
+        , groupSequenceNumber(0)
+        , groupAckTimer(-1)
+        , groupRetransmissionTimer(-1)
+        , timerService(nullptr)
     {
     }
 
@@ -105,6 +113,9 @@ public:
     /** override from BaseApp */
     virtual void handleSelfMsg(cMessage* msg) override;
 
+    /** records the statistics of the timer service */
+    virtual void finish() override;
+
     /**
      * Request start of JoinManeuver to leader
      * @param int platoonId the id of the platoon to join
@@ -128,25 +139,20 @@ public:
 
     /**
      * Returns whether this car is in a maneuver
-     * @return bool true, if this car is in a maneuver, else false
+     * @return bool true, if at least one maneuver is in progress, else false
      */
     bool isInManeuver() const
     {
-        return inManeuver;
+        return maneuverManager.isInManeuver();
     }
 
     /**
-     * Set whether this car is in a maneuver
-     * @param bool b whether this car is in a maneuver
-     * @param maneuver the maneuver that is currently active
+     * Returns the manager keeping track of the maneuvers of this vehicle and
+     * of the resources they lock
      */
-    void setInManeuver(bool b, Maneuver* maneuver)
+    ManeuverManager* getManeuverManager()
     {
-        inManeuver = b;
-        if (inManeuver)
-            activeManeuver = maneuver;
-        else
-            activeManeuver = nullptr;
+        return &maneuverManager;
     }
 
     BasePositionHelper* getPositionHelper()
@@ -179,6 +185,15 @@ public:
         return plexeTraciVehicle.get();
     }
 
+    /**
+     * Returns the timer service maneuvers should use for their timeouts,
+     * instead of scheduling their own self messages
+     */
+    TimerService* getTimerService()
+    {
+        return timerService;
+    }
+
     /**
      * Sends a unicast message
      *
@@ -188,6 +203,23 @@ public:
      */
     virtual void sendUnicast(cPacket* msg, int destination);
 
+    /**
+     * Sends a message to a group of vehicles. If groupSend is enabled, the
+     * message is sent once in a broadcast frame listing the recipients. The
+     * recipients acknowledge it with aggregated GroupAck replies, and the
+     * message is retransmitted to the ones that did not acknowledge it. If
+     * any recipient still did not acknowledge it after the maximum number of
+     * retransmissions, the maneuvers are notified as for a failed unicast
+     * transmission. The message they get has destinationId == -1 and lists
+     * the recipients that did not acknowledge it.
+     * If groupSend is disabled, a copy of the message is sent as unicast to
+     * each recipient, setting its destinationId.
+     *
+     * @param msg message to send. the method takes ownership of it
+     * @param destinations ids of the recipients
+     */
+    virtual void sendToGroup(ManeuverMessage* msg, const std::vector<int>& destinations);
+
     /**
      * Fills members of a ManeuverMessage
      *
@@ -239,6 +271,12 @@ public:
      */
     virtual void handleUpdatePlatoonFormation(const UpdatePlatoonFormation* msg);
 
+    /**
+     * Returns whether a vehicle can join the platoon of this vehicle, i.e.,
+     * whether this vehicle is a leader (or alone) and the resources needed to
+     * accept a joiner (see JoinAtBack::processJoinRequest()) are not in use
+     * by another maneuver
+     */
     bool isJoinAllowed() const;
 
     /**
@@ -269,10 +307,8 @@ protected:
      */
     virtual void onManeuverMessage(ManeuverMessage* mm);
 
-    /** am i in a maneuver? */
-    bool inManeuver;
-    /** which maneuver is currently active? */
-    Maneuver* activeManeuver;
+    /** maneuvers of this vehicle and resources they lock */
+    ManeuverManager maneuverManager;
 
     /** used to receive the "retries exceeded" signal **/
     virtual void receiveSignal(cComponent* src, simsignal_t id, cObject* value, cObject* details) override;
@@ -280,6 +316,36 @@ protected:
     /** used by maneuvers to schedule self messages, as they are not omnet modules */
     virtual void scheduleSelfMsg(simtime_t t, cMessage* msg);
 
+    /**
+     * Notifies the maneuvers that a message could not be delivered
+     *
+     * @param mm the message that could not be delivered
+     */
+    virtual void onFailedTransmissionAttempt(const ManeuverMessage* mm);
+
+    /**
+     * Retransmits the group messages whose acknowledgements did not arrive in
+     * time, reporting as failed the ones with no retransmissions left
+     */
+    void retransmitGroupMessages();
+
+    /** sends the aggregated acknowledgements for the received group messages */
+    void sendGroupAcks();
+
+    /**
+     * Handles the group specific part of a received maneuver message
+     *
+     * @return true if the message should be processed, false if it should
+     * be discarded because it is not for this vehicle or it is a duplicate
+     */
+    bool receiveGroupMessage(const ManeuverMessage* mm);
+
+    /** handles the acknowledgements for the messages sent to a group */
+    void handleGroupAck(const GroupAck* msg);
+
+    /** sends a maneuver message in a frame addressed to the given destination (-1 for broadcast) */
+    void sendFrame(cPacket* msg, int destination);
+
     BaseScenario* scenario;
 
 private:
@@ -289,6 +355,42 @@ private:
     JoinManeuver* joinManeuver;
     /** platoons merge maneuver implementation */
     JoinManeuver* mergeManeuver;
+
+    /** a message sent to a group, waiting for the acknowledgements of its recipients */
+    struct PendingGroupMessage {
+        /** copy of the message, used for retransmissions */
+        ManeuverMessage* msg;
+        /** recipients that did not acknowledge the message yet */
+        std::set<int> missing;
+        /** number of retransmissions performed so far */
+        int retransmissions;
+        /** time at which the message is retransmitted if not acknowledged */
+        simtime_t deadline;
+    };
+
+    /** whether to send group messages in a single broadcast frame */
+    bool groupSend;
+    /** time to wait for acknowledgements before retransmitting a group message */
+    simtime_t groupAckTimeout;
+    /** maximum number of retransmissions of a group message */
+    int groupMaxRetransmissions;
+    /** time a recipient waits to aggregate the acknowledgements */
+    simtime_t groupAckDelay;
+    /** sequence number of the next group message */
+    int groupSequenceNumber;
+    /** group messages sent and not acknowledged by all recipients, by sequence number */
+    std::map<int, PendingGroupMessage> pendingGroupMessages;
+    /** acknowledgements to be sent, as sender and sequence number pairs */
+    std::vector<std::pair<int, int>> pendingGroupAcks;
+    /** group messages already received, by sender. used to discard retransmissions */
+    std::map<int, std::set<int>> receivedGroupMessages;
+    /** timer sending the aggregated acknowledgements */
+    int groupAckTimer;
+    /** timer retransmitting the group messages not acknowledged in time */
+    int groupRetransmissionTimer;
+
+    /** timers of this vehicle, multiplexed on a single self message */
+    TimerService* timerService;
 };
 
 } // namespace plexe
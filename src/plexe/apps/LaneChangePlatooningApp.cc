@@ -22,7 +22,6 @@
 #include "plexe/apps/GeneralPlatooningApp.h"
 #include "plexe/protocols/BaseProtocol.h"
 #include "plexe/apps/LaneChangePlatooningApp.h"
-#include "veins/modules/mac/ieee80211p/Mac1609_4.h"
 
 
 using namespace veins;
@@ -42,69 +41,21 @@ void LaneChangePlatooningApp::initialize(int stage)
         else
             throw new cRuntimeError("Invalid laneChange maneuver implementation chosen");
 
-        scenario = FindModule<BaseScenario*>::findSubModule(getParentModule());
-    }
-}
+        // messages, beacons, and self messages are dispatched to the lane
+        // change together with the join and merge maneuvers
+        getManeuverManager()->addManeuver(laneChangeManeuver);
 
-void LaneChangePlatooningApp::handleSelfMsg(cMessage* msg)
-{
-    if (laneChangeManeuver && laneChangeManeuver->handleSelfMsg(msg)) return;
-    else if (laneChangeManeuver && laneChangeManeuver->handleSelfMsg(msg)) return;
-    BaseApp::handleSelfMsg(msg);
-}
-
-void LaneChangePlatooningApp::onPlatoonBeacon(const PlatooningBeacon* pb)
-{
-    laneChangeManeuver->onPlatoonBeacon(pb);
-    // maintain platoon
-    BaseApp::onPlatoonBeacon(pb);
-}
-
-void LaneChangePlatooningApp::onManeuverMessage(ManeuverMessage* mm)
-{
-    if (activeManeuver) {
-        activeManeuver->onManeuverMessage(mm);
-    }
-    else {
-        laneChangeManeuver->onManeuverMessage(mm);
+        scenario = FindModule<BaseScenario*>::findSubModule(getParentModule());
     }
-    delete mm;
 }
 
-
 void LaneChangePlatooningApp::startChangeLaneManeuver(int platoonId, int leaderId)
 {
     ASSERT(getPlatoonRole() == PlatoonRole::NONE);
-    ASSERT(!isInManeuver());
 
     laneChangeManeuver->startManeuver(nullptr);
 }
 
-
-
-void LaneChangePlatooningApp::receiveSignal(cComponent* src, simsignal_t id, cObject* value, cObject* details)
-{
-    if (id == Mac1609_4::sigRetriesExceeded) {
-        BaseFrame1609_4* frame = check_and_cast<BaseFrame1609_4*>(value);
-        ManeuverMessage* mm = check_and_cast<ManeuverMessage*>(frame->getEncapsulatedPacket());
-        if (frame) {
-            laneChangeManeuver->onFailedTransmissionAttempt(mm);
-        }
-    }
-}
-
-void LaneChangePlatooningApp::sendTimeoutMsg()
-{
-    timeoutMsg = new cMessage("TimeoutMsg");
-    take(timeoutMsg);
-    scheduleAt(simTime() + SimTime(1), timeoutMsg);
-}
-
-void LaneChangePlatooningApp::resetTimeoutMsg()
-{
-    cancelAndDelete(timeoutMsg);
-}
-
 LaneChangePlatooningApp::~LaneChangePlatooningApp()
 {
     delete laneChangeManeuver;
@@ -75,39 +75,9 @@ public:
     /** override from GeneralPlatooningApp */
     virtual void initialize(int stage) override;
 
-    /** override from GeneralPlatooningApp */
-    virtual void handleSelfMsg(cMessage* msg) override;
-
-    void sendTimeoutMsg();
-
-    void resetTimeoutMsg();
-
-protected:
-    /** used to receive the "retries exceeded" signal **/
-    virtual void receiveSignal(cComponent* src, simsignal_t id, cObject* value, cObject* details) override;
-
-    /**
-     * Handles PlatoonBeacons
-     *
-     * @param PlatooningBeacon pb to handle
-     */
-    virtual void onPlatoonBeacon(const PlatooningBeacon* pb) override;
-
-    /**
-     * Handles ManeuverMessages
-     *
-     * @param ManeuverMessage mm to handle
-     */
-    virtual void onManeuverMessage(ManeuverMessage* mm);
-
-
-
 private:
     /** platoons change lane implementation */
     Maneuver* laneChangeManeuver;
-
-    // message used to schedule timeouts
-    cMessage* timeoutMsg;
 };
 
 } // namespace plexe
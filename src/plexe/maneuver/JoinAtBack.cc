@@ -27,18 +27,30 @@ JoinAtBack::JoinAtBack(GeneralPlatooningApp* app)
     : JoinManeuver(app)
     , joinManeuverState(JoinManeuverState::IDLE)
 {
+    registerJoinPhases("join");
+}
+
+void JoinAtBack::registerJoinPhases(const std::string& prefix)
+{
+    // names follow the order of JoinManeuverState
+    registerPhases(prefix, {"Idle", "JoinerWaitReply", "JoinerWaitInformation", "JoinerMoveInPosition", "JoinerWaitJoin", "LeaderWaitJoinerInPosition", "LeaderWaitJoinerToJoin"});
+}
+
+void JoinAtBack::setState(JoinManeuverState state)
+{
+    joinManeuverState = state;
+    setPhase((int) state);
 }
 
 bool JoinAtBack::initializeJoinManeuver(const void* parameters)
 {
     JoinManeuverParameters* pars = (JoinManeuverParameters*) parameters;
     if (joinManeuverState == JoinManeuverState::IDLE) {
-        if (app->isInManeuver()) {
+        if (!lockResources(joinerResources, ManeuverManager::LockMode::EXCLUSIVE)) {
             LOG << positionHelper->getId() << " cannot begin the maneuver because already involved in another one\n";
             return false;
         }
 
-        app->setInManeuver(true, this);
         app->setPlatoonRole(PlatoonRole::JOINER);
 
         // collect information about target Platoon
@@ -47,7 +59,7 @@ bool JoinAtBack::initializeJoinManeuver(const void* parameters)
         targetPlatoonData->platoonLeader = pars->leaderId;
 
         // after successful initialization we are going to send a request and wait for a reply
-        joinManeuverState = JoinManeuverState::J_WAIT_REPLY;
+        setState(JoinManeuverState::J_WAIT_REPLY);
 
         return true;
     }
@@ -62,7 +74,7 @@ void JoinAtBack::startManeuver(const void* parameters)
         // send join request to leader
         LOG << positionHelper->getId() << " sending JoinPlatoonRequesto to platoon with id " << targetPlatoonData->platoonId << " (leader id " << targetPlatoonData->platoonLeader << ")\n";
         JoinPlatoonRequest* req = createJoinPlatoonRequest(positionHelper->getId(), positionHelper->getExternalId(), targetPlatoonData->platoonId, targetPlatoonData->platoonLeader, traciVehicle->getLaneIndex(), mobility->getPositionAt(simTime()).x, mobility->getPositionAt(simTime()).y);
-        app->sendUnicast(req, targetPlatoonData->platoonLeader);
+        sendUnicast(req, targetPlatoonData->platoonLeader);
     }
 }
 
@@ -98,8 +110,8 @@ void JoinAtBack::onPlatoonBeacon(const PlatooningBeacon* pb)
                 // send move to position response to confirm the parameters
                 LOG << positionHelper->getId() << " sending MoveToPositionAck to platoon with id " << targetPlatoonData->platoonId << " (leader id " << targetPlatoonData->platoonLeader << ")\n";
                 MoveToPositionAck* ack = createMoveToPositionAck(positionHelper->getId(), positionHelper->getExternalId(), targetPlatoonData->platoonId, targetPlatoonData->platoonLeader, targetPlatoonData->platoonSpeed, targetPlatoonData->platoonLane, targetPlatoonData->newFormation);
-                app->sendUnicast(ack, targetPlatoonData->newFormation.at(0));
-                joinManeuverState = JoinManeuverState::J_WAIT_JOIN;
+                sendUnicast(ack, targetPlatoonData->newFormation.at(0));
+                setState(JoinManeuverState::J_WAIT_JOIN);
             }
         }
     }
@@ -116,16 +128,23 @@ bool JoinAtBack::processJoinRequest(const JoinPlatoonRequest* msg)
 
     if (app->getPlatoonRole() != PlatoonRole::LEADER && app->getPlatoonRole() != PlatoonRole::NONE) return false;
 
+    // take the resources before answering, so that the joiner is never
+    // granted a maneuver we cannot run
     bool permission = app->isJoinAllowed();
+    if (permission && !(lockResources(leaderExclusiveResources, ManeuverManager::LockMode::EXCLUSIVE) && lockResources(leaderSharedResources, ManeuverManager::LockMode::SHARED))) {
+        // isJoinAllowed() found no locks in our way, so this maneuver held
+        // nothing before and can drop a partially acquired lock
+        unlockResources();
+        permission = false;
+    }
 
     // send response to the joiner
     LOG << positionHelper->getId() << " sending JoinPlatoonResponse to vehicle with id " << msg->getVehicleId() << " (permission to join: " << (permission ? "permitted" : "not permitted") << ")\n";
     JoinPlatoonResponse* response = createJoinPlatoonResponse(positionHelper->getId(), positionHelper->getExternalId(), msg->getPlatoonId(), msg->getVehicleId(), permission);
-    app->sendUnicast(response, msg->getVehicleId());
+    sendUnicast(response, msg->getVehicleId());
 
     if (!permission) return false;
 
-    app->setInManeuver(true, this);
     app->setPlatoonRole(PlatoonRole::LEADER);
 
     // disable lane changing during maneuver
@@ -143,7 +162,7 @@ bool JoinAtBack::processJoinRequest(const JoinPlatoonRequest* msg)
     joinerData->newFormation.push_back(joinerData->joinerId);
 
     // after processing the request we are sending a MoveToPosition message and wait for the joiner
-    joinManeuverState = JoinManeuverState::L_WAIT_JOINER_IN_POSITION;
+    setState(JoinManeuverState::L_WAIT_JOINER_IN_POSITION);
     return true;
 }
 
@@ -152,7 +171,7 @@ void JoinAtBack::handleJoinPlatoonRequest(const JoinPlatoonRequest* msg)
     if (processJoinRequest(msg)) {
         LOG << positionHelper->getId() << " sending MoveToPosition to vehicle with id " << msg->getVehicleId() << "\n";
         MoveToPosition* mtp = createMoveToPosition(positionHelper->getId(), positionHelper->getExternalId(), positionHelper->getPlatoonId(), joinerData->joinerId, positionHelper->getPlatoonSpeed(), positionHelper->getPlatoonLane(), joinerData->newFormation);
-        app->sendUnicast(mtp, joinerData->joinerId);
+        sendUnicast(mtp, joinerData->joinerId);
     }
 }
 
@@ -172,16 +191,17 @@ void JoinAtBack::handleJoinPlatoonResponse(const JoinPlatoonResponse* msg)
     if (msg->getPermitted()) {
         LOG << positionHelper->getId() << " received JoinPlatoonResponse (allowed to join)\n";
         // wait for information about the join maneuver
-        joinManeuverState = JoinManeuverState::J_WAIT_INFORMATION;
+        setState(JoinManeuverState::J_WAIT_INFORMATION);
         // disable lane changing during maneuver
         plexeTraciVehicle->setFixedLane(traciVehicle->getLaneIndex());
     }
     else {
         LOG << positionHelper->getId() << " received JoinPlatoonResponse (not allowed to join)\n";
         // abort maneuver
-        joinManeuverState = JoinManeuverState::IDLE;
+        recordAbort(AbortReason::REJECTED);
+        setState(JoinManeuverState::IDLE);
         app->setPlatoonRole(PlatoonRole::NONE);
-        app->setInManeuver(false, nullptr);
+        unlockResources();
     }
 }
 
@@ -219,7 +239,7 @@ void JoinAtBack::handleMoveToPosition(const MoveToPosition* msg)
     plexeTraciVehicle->setCruiseControlDesiredSpeed(targetPlatoonData->platoonSpeed + (30 / 3.6));
     plexeTraciVehicle->setActiveController(FAKED_CACC);
 
-    joinManeuverState = JoinManeuverState::J_MOVE_IN_POSITION;
+    setState(JoinManeuverState::J_MOVE_IN_POSITION);
 }
 
 void JoinAtBack::handleMoveToPositionAck(const MoveToPositionAck* msg)
@@ -236,8 +256,8 @@ void JoinAtBack::handleMoveToPositionAck(const MoveToPositionAck* msg)
     // tell the joiner to join the platoon
     LOG << positionHelper->getId() << " sending JoinFormation to vehicle with id " << joinerData->joinerId << "\n";
     JoinFormation* jf = createJoinFormation(positionHelper->getId(), positionHelper->getExternalId(), positionHelper->getPlatoonId(), joinerData->joinerId, positionHelper->getPlatoonSpeed(), traciVehicle->getLaneIndex(), joinerData->newFormation);
-    app->sendUnicast(jf, joinerData->joinerId);
-    joinManeuverState = JoinManeuverState::L_WAIT_JOINER_TO_JOIN;
+    sendUnicast(jf, joinerData->joinerId);
+    setState(JoinManeuverState::L_WAIT_JOINER_TO_JOIN);
 }
 
 void JoinAtBack::handleJoinFormation(const JoinFormation* msg)
@@ -266,12 +286,12 @@ void JoinAtBack::handleJoinFormation(const JoinFormation* msg)
     // tell the leader that we're now in the platoon
     LOG << positionHelper->getId() << " received JoinFormation. Sending JoinFormationAck and performing final approach to platoon " << positionHelper->getPlatoonId() << "\n";
     JoinFormationAck* jfa = createJoinFormationAck(positionHelper->getId(), positionHelper->getExternalId(), positionHelper->getPlatoonId(), targetPlatoonData->platoonLeader, positionHelper->getPlatoonSpeed(), traciVehicle->getLaneIndex(), formation);
-    app->sendUnicast(jfa, positionHelper->getLeaderId());
+    sendUnicast(jfa, positionHelper->getLeaderId());
 
     app->setPlatoonRole(PlatoonRole::FOLLOWER);
-    joinManeuverState = JoinManeuverState::IDLE;
+    setState(JoinManeuverState::IDLE);
 
-    app->setInManeuver(false, nullptr);
+    unlockResources();
 }
 
 // final state for leader
@@ -290,15 +310,12 @@ void JoinAtBack::handleJoinFormationAck(const JoinFormationAck* msg)
 
     LOG << positionHelper->getId() << " received JoinFormationAck. Sending UpdatePlatoonFormation to all members\n";
     // send to all vehicles in Platoon
-    for (unsigned int i = 1; i < positionHelper->getPlatoonSize(); i++) {
-        UpdatePlatoonFormation* dup = app->createUpdatePlatoonFormation(positionHelper->getId(), positionHelper->getExternalId(), positionHelper->getPlatoonId(), -1, positionHelper->getPlatoonSpeed(), traciVehicle->getLaneIndex(), joinerData->newFormation);
-        int dest = positionHelper->getMemberId(i);
-        dup->setDestinationId(dest);
-        app->sendUnicast(dup, dest);
-    }
+    const std::vector<int>& formation = positionHelper->getPlatoonFormation();
+    UpdatePlatoonFormation* upf = app->createUpdatePlatoonFormation(positionHelper->getId(), positionHelper->getExternalId(), positionHelper->getPlatoonId(), -1, positionHelper->getPlatoonSpeed(), traciVehicle->getLaneIndex(), joinerData->newFormation);
+    sendToGroup(upf, std::vector<int>(formation.begin() + 1, formation.end()));
 
-    joinManeuverState = JoinManeuverState::IDLE;
-    app->setInManeuver(false, nullptr);
+    setState(JoinManeuverState::IDLE);
+    unlockResources();
 }
 
 } // namespace plexe
@@ -45,6 +45,18 @@ public:
     JoinAtBack(GeneralPlatooningApp* app);
     virtual ~JoinAtBack(){};
 
+    /**
+     * Resources locked by the leader accepting a joiner: the back of the
+     * platoon is reserved to the joiner, while the lane and the role of the
+     * leader must not change until the joiner is in the platoon. Other
+     * maneuvers keeping the lane, e.g., a lane change still being
+     * negotiated, can run at the same time
+     */
+    static const int leaderExclusiveResources = ManeuverManager::FORMATION_TAIL;
+    static const int leaderSharedResources = ManeuverManager::LANE | ManeuverManager::LEADER_ROLE;
+    /** resources locked by the joining vehicle, which changes lane and role */
+    static const int joinerResources = ManeuverManager::LANE | ManeuverManager::FORMATION_TAIL | ManeuverManager::LEADER_ROLE;
+
     /**
      * This method is invoked by the generic application to start the maneuver
      *
@@ -218,6 +230,12 @@ protected:
     /** the current state in the join maneuver */
     JoinManeuverState joinManeuverState;
 
+    /** changes the state of the join maneuver, recording the time spent in the previous one */
+    void setState(JoinManeuverState state);
+
+    /** registers the signals recording the phases of the maneuver, using the given prefix for their names */
+    void registerJoinPhases(const std::string& prefix);
+
     /** the data about the target platoon */
     std::unique_ptr<TargetPlatoonData> targetPlatoonData;
 
@@ -27,31 +27,13 @@ namespace plexe {
 JoinManeuver::JoinManeuver(GeneralPlatooningApp* app)
     : Maneuver(app)
 {
-}
-
-void JoinManeuver::onManeuverMessage(const ManeuverMessage* mm)
-{
-    if (const MergePlatoonRequest* msg = dynamic_cast<const MergePlatoonRequest*>(mm)) {
-        handleMergePlatoonRequest(msg);
-    }
-    else if (const JoinPlatoonRequest* msg = dynamic_cast<const JoinPlatoonRequest*>(mm)) {
-        handleJoinPlatoonRequest(msg);
-    }
-    else if (const JoinPlatoonResponse* msg = dynamic_cast<const JoinPlatoonResponse*>(mm)) {
-        handleJoinPlatoonResponse(msg);
-    }
-    else if (const MoveToPosition* msg = dynamic_cast<const MoveToPosition*>(mm)) {
-        handleMoveToPosition(msg);
-    }
-    else if (const MoveToPositionAck* msg = dynamic_cast<const MoveToPositionAck*>(mm)) {
-        handleMoveToPositionAck(msg);
-    }
-    else if (const JoinFormation* msg = dynamic_cast<const JoinFormation*>(mm)) {
-        handleJoinFormation(msg);
-    }
-    else if (const JoinFormationAck* msg = dynamic_cast<const JoinFormationAck*>(mm)) {
-        handleJoinFormationAck(msg);
-    }
+    registerMessageHandler<MergePlatoonRequest>(MERGE_PLATOON_REQUEST, [this](const MergePlatoonRequest* msg) { handleMergePlatoonRequest(msg); });
+    registerMessageHandler<JoinPlatoonRequest>(JOIN_PLATOON_REQUEST, [this](const JoinPlatoonRequest* msg) { handleJoinPlatoonRequest(msg); });
+    registerMessageHandler<JoinPlatoonResponse>(JOIN_PLATOON_RESPONSE, [this](const JoinPlatoonResponse* msg) { handleJoinPlatoonResponse(msg); });
+    registerMessageHandler<MoveToPosition>(MOVE_TO_POSITION, [this](const MoveToPosition* msg) { handleMoveToPosition(msg); });
+    registerMessageHandler<MoveToPositionAck>(MOVE_TO_POSITION_ACK, [this](const MoveToPositionAck* msg) { handleMoveToPositionAck(msg); });
+    registerMessageHandler<JoinFormation>(JOIN_FORMATION, [this](const JoinFormation* msg) { handleJoinFormation(msg); });
+    registerMessageHandler<JoinFormationAck>(JOIN_FORMATION_ACK, [this](const JoinFormationAck* msg) { handleJoinFormationAck(msg); });
 }
 
 JoinPlatoonRequest* JoinManeuver::createJoinPlatoonRequest(int vehicleId, std::string externalId, int platoonId, int destinationId, int currentLaneIndex, double xPos, double yPos)
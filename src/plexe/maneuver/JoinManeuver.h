@@ -51,8 +51,6 @@ public:
     JoinManeuver(GeneralPlatooningApp* app);
     virtual ~JoinManeuver(){};
 
-    virtual void onManeuverMessage(const ManeuverMessage* mm) override;
-
 protected:
     /**
      * Creates a JoinPlatoonRequest message
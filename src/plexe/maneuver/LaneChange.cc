@@ -18,27 +18,35 @@ LaneChange::LaneChange(GeneralPlatooningApp* app, int securityDistance)
     , laneChangeManeuverState(LaneChangeManeuverState::IDLE)
     , securityDistance(securityDistance)
 {
+    registerMessageHandler<WarnLaneChange>(WARN_LANE_CHANGE, [this](const WarnLaneChange* msg) { handleWarnLaneChange(msg); });
+    registerMessageHandler<WarnLaneChangeAck>(WARN_LANE_CHANGE_ACK, [this](const WarnLaneChangeAck* msg) { handleWarnLaneChangeAck(msg); });
+    registerMessageHandler<StartSignal>(START_SIGNAL, [this](const StartSignal* msg) { handleStartSignal(msg); });
+    registerMessageHandler<LaneChanged>(LANE_CHANGED, [this](const LaneChanged* msg) { handleLaneChanged(msg); });
+    registerMessageHandler<LaneChangeClose>(LANE_CHANGE_CLOSE, [this](const LaneChangeClose* msg) { handleLaneChangeClose(msg); });
+    registerMessageHandler<Again>(AGAIN, [this](const Again* msg) { handleAgain(msg); });
+    registerMessageHandler<Abort>(ABORT, [this](const Abort*) { handleAbort(); });
+    // names follow the order of LaneChangeManeuverState
+    registerPhases("laneChange", {"Idle", "LaneChange", "WaitReply", "WaitAllChanged", "PrepareLaneChange", "CompleteLaneChange"});
+    timeoutTimer = app->getTimerService()->registerTimer("laneChangeTimeout", [this]() { onTimeout(); });
 }
 
-bool LaneChange::handleSelfMsg(cMessage* msg)
+void LaneChange::onTimeout()
 {
-    std::string title = msg->getName();
-    if (title.compare("TimeoutMsg") == 0) {
-        abortManeuver();
-    }
+    recordAbort(AbortReason::TIMEOUT);
+    abortManeuver();
+}
 
-    return true;
+void LaneChange::setState(LaneChangeManeuverState state)
+{
+    laneChangeManeuverState = state;
+    setPhase((int) state);
 }
 
 bool LaneChange::isLaneFree(int destination)
 {
-    int state, state2;
-    plexeTraciVehicle->getLaneChangeState(destination-positionHelper->getPlatoonLane(), state, state2);
-    int direction = destination-positionHelper->getPlatoonLane() > 0 ? 0 : 1;
-    double minBack = plexeTraciVehicle->getMinNeighDistance(direction, 0);
-    double minFront = plexeTraciVehicle->getMinNeighDistance(direction, 1);
+    traci::CommandInterface::LaneGapInfo gap = plexeTraciVehicle->getLaneGapInfo(destination-positionHelper->getPlatoonLane());
 
-    if ((state & (1 << 13)) != 0 || minBack < securityDistance || minFront < securityDistance)
+    if ((gap.state & (1 << 13)) != 0 || gap.minBack < securityDistance || gap.minFront < securityDistance)
     {
         LOG << positionHelper->getId() << " cannot begin the maneuver because lane " << destination << " is occupied\n";
         return false;
@@ -49,19 +57,22 @@ bool LaneChange::isLaneFree(int destination)
 bool LaneChange::initializeLaneChangeManeuver()
 {
     if (laneChangeManeuverState == LaneChangeManeuverState::IDLE && app->getPlatoonRole() == PlatoonRole::LEADER) {
-        if (app->isInManeuver())
+        if (!isLaneFree(nextDestination)) return false;
+
+        // while negotiating, the platoon keeps its lane, so maneuvers not
+        // changing it (e.g., accepting a joiner) can run at the same time.
+        // the lane is locked exclusively when the platoon actually moves, so
+        // do not start if another maneuver already needs the current lane
+        if (!app->getManeuverManager()->canLock(this, ManeuverManager::LANE, ManeuverManager::LockMode::EXCLUSIVE) || !lockResources(ManeuverManager::LANE | ManeuverManager::LEADER_ROLE, ManeuverManager::LockMode::SHARED))
         {
             LOG << positionHelper->getId() << " cannot begin the maneuver because already involved in another one\n";
             return false;
         }
-        if (!isLaneFree(nextDestination)) return false;
-
-        app->setInManeuver(true, this);
 
         // after successful initialization we are going to send a request and wait for a reply
-        laneChangeManeuverState = LaneChangeManeuverState::WAIT_REPLY;
+        setState(LaneChangeManeuverState::WAIT_REPLY);
 
-        static_cast<LaneChangePlatooningApp*>(app)->sendTimeoutMsg();
+        app->getTimerService()->arm(timeoutTimer, timeout);
 
         return true;
     }
@@ -72,18 +83,24 @@ bool LaneChange::initializeLaneChangeManeuver()
 
 void LaneChange::sendLaneChangeRequest(int leaderId, std::string externalId, int platoonId)
 {
-    for (int i: positionHelper->getPlatoonFormation()) {
-        if (i != leaderId){
-            LOG << positionHelper->getId() << " sending laneChangeRequest to " << i << "\n";
-            WarnLaneChange* msg = new WarnLaneChange("WarnLaneChange");
-            msg->setPlatoonLaneDestination(nextDestination);
-            app->fillManeuverMessage(msg, leaderId, externalId, platoonId, i);
-            app->sendUnicast(msg, i);
-        }
+    LOG << positionHelper->getId() << " sending laneChangeRequest to the followers\n";
+    WarnLaneChange* msg = new WarnLaneChange("WarnLaneChange");
+    msg->setPlatoonLaneDestination(nextDestination);
+    app->fillManeuverMessage(msg, leaderId, externalId, platoonId, -1);
+    sendToGroup(msg, getMembersExcept(leaderId));
+}
+
+std::vector<int> LaneChange::getMembersExcept(int id)
+{
+    std::vector<int> members;
+    for (int i : positionHelper->getPlatoonFormation()) {
+        if (i != id) members.push_back(i);
     }
+    return members;
 }
 
 void LaneChange::resetReceivedAck() {
+    receivedAck.clear();
     for (int i : positionHelper->getPlatoonFormation()) {
         if (i != positionHelper->getLeaderId()) {
             receivedAck[i] = false;
@@ -104,26 +121,29 @@ void LaneChange::startManeuver(const void* parameters)
 
 void LaneChange::handleAbort()
 {
+    // followers refuse a WarnLaneChange by aborting before they enter the
+    // maneuver, so they cannot record it. the leader does it for them
+    if (laneChangeManeuverState == LaneChangeManeuverState::WAIT_REPLY)
+        recordAbort(AbortReason::REJECTED);
+    else
+        recordAbort(AbortReason::ABORT_RECEIVED);
+    app->getTimerService()->cancel(timeoutTimer);
     nextDestination = -1;
-    app->setInManeuver(false, this);
-    laneChangeManeuverState = LaneChangeManeuverState::IDLE;
+    unlockResources();
+    setState(LaneChangeManeuverState::IDLE);
 }
 
 void LaneChange::abortManeuver()
 {
-    for (int i: positionHelper->getPlatoonFormation())
-    {
-        if (i != positionHelper->getId())
-        {
-            LOG << "Platoon member " << positionHelper->getId() << " sending Abort to member " << i << "\n";
-            Abort* response = new Abort("Abort");
-            app->fillManeuverMessage(response, positionHelper->getId(), positionHelper->getExternalId(), positionHelper->getPlatoonId(), i);
-            app->sendUnicast(response, i);
-        }
-    }
+    recordAbort(AbortReason::OTHER);
+    app->getTimerService()->cancel(timeoutTimer);
+    LOG << "Platoon member " << positionHelper->getId() << " sending Abort to the other members\n";
+    Abort* response = new Abort("Abort");
+    app->fillManeuverMessage(response, positionHelper->getId(), positionHelper->getExternalId(), positionHelper->getPlatoonId(), -1);
+    sendToGroup(response, getMembersExcept(positionHelper->getId()));
     nextDestination = -1;
-    app->setInManeuver(false, this);
-    laneChangeManeuverState = LaneChangeManeuverState::IDLE;
+    unlockResources();
+    setState(LaneChangeManeuverState::IDLE);
 }
 
 void LaneChange::onFailedTransmissionAttempt(const ManeuverMessage* mm)
@@ -136,32 +156,13 @@ void LaneChange::onPlatoonBeacon(const PlatooningBeacon* pb)
 
 }
 
-void LaneChange::onManeuverMessage(const ManeuverMessage* mm)
-{
-    if (const WarnLaneChange* msg = dynamic_cast<const WarnLaneChange*>(mm)) {
-        handleWarnLaneChange(msg);
-    } else if (const WarnLaneChangeAck* msg = dynamic_cast<const WarnLaneChangeAck*>(mm)) {
-        handleWarnLaneChangeAck(msg);
-    } else if (const StartSignal* msg = dynamic_cast<const StartSignal*>(mm)) {
-        handleStartSignal(msg);
-    } else if (const LaneChanged* msg = dynamic_cast<const LaneChanged*>(mm)) {
-        handleLaneChanged(msg);
-    } else if (const LaneChangeClose* msg = dynamic_cast<const LaneChangeClose*>(mm)) {
-        handleLaneChangeClose(msg);
-    } else if (const Again* msg = dynamic_cast<const Again*>(mm)) {
-        handleAgain(msg);
-    } else if (const Abort* msg = dynamic_cast<const Abort*>(mm)) {
-        handleAbort();
-    }
-}
-
 bool LaneChange::processLaneChangeClose(const LaneChangeClose* msg)
 {
     if (msg->getPlatoonId() != positionHelper->getPlatoonId()) return false;
 
     if (app->getPlatoonRole() != PlatoonRole::FOLLOWER) return false;
 
-    if (laneChangeManeuverState != LaneChangeManeuverState::COMPLETE_LANE_CHANGE || !app->isInManeuver()) return false;
+    if (laneChangeManeuverState != LaneChangeManeuverState::COMPLETE_LANE_CHANGE || !app->getManeuverManager()->isActive(this)) return false;
 
     return true;
 }
@@ -177,9 +178,11 @@ void LaneChange::handleLaneChangeClose(const LaneChangeClose* msg)
 {
     if (processLaneChangeClose(msg)) {
         nextDestination = -1;
-        app->setInManeuver(false, this);
-        laneChangeManeuverState = LaneChangeManeuverState::IDLE;
-    } else {
+        unlockResources();
+        setState(LaneChangeManeuverState::IDLE);
+    } else if (app->getManeuverManager()->isActive(this)) {
+        // a vehicle not taking part in the lane change has nothing to abort
+        recordAbort(AbortReason::UNEXPECTED_MESSAGE);
         abortManeuver();
     }
 //TODO test, is only for restart infinite time the maneuver for testing.
@@ -196,7 +199,7 @@ bool LaneChange::processLaneChanged(const LaneChanged* msg)
 
     if (app->getPlatoonRole() != PlatoonRole::LEADER) return false;
 
-    if (laneChangeManeuverState != LaneChangeManeuverState::WAIT_ALL_CHANGED || !app->isInManeuver()) return false;
+    if (laneChangeManeuverState != LaneChangeManeuverState::WAIT_ALL_CHANGED || !app->getManeuverManager()->isActive(this)) return false;
 
     receivedAck[msg->getVehicleId()] = true;
 
@@ -205,7 +208,7 @@ bool LaneChange::processLaneChanged(const LaneChanged* msg)
         if(!x.second) return false;
     }
 
-    static_cast<LaneChangePlatooningApp*>(app)->resetTimeoutMsg();
+    app->getTimerService()->cancel(timeoutTimer);
     resetReceivedAck();
     return true;
 }
@@ -214,19 +217,13 @@ void LaneChange::handleLaneChanged(const LaneChanged* msg)
 {
     if (processLaneChanged(msg)) {
         // send response to followers
-        for (int i: positionHelper->getPlatoonFormation())
-        {
-            if (i != positionHelper->getLeaderId())
-            {
-                LOG << "Leader " << positionHelper->getId() << " sending laneChangeClose to the follower with id " << i << "\n";
-                LaneChangeClose* response = new LaneChangeClose("LaneChangeClose");
-                app->fillManeuverMessage(response, positionHelper->getId(), positionHelper->getExternalId(), positionHelper->getPlatoonId(), i);
-                app->sendUnicast(response, i);
-            }
-        }
+        LOG << "Leader " << positionHelper->getId() << " sending laneChangeClose to the followers\n";
+        LaneChangeClose* response = new LaneChangeClose("LaneChangeClose");
+        app->fillManeuverMessage(response, positionHelper->getId(), positionHelper->getExternalId(), positionHelper->getPlatoonId(), -1);
+        sendToGroup(response, getMembersExcept(positionHelper->getLeaderId()));
         nextDestination = -1;
-        app->setInManeuver(false, this);
-        laneChangeManeuverState = LaneChangeManeuverState::IDLE;
+        unlockResources();
+        setState(LaneChangeManeuverState::IDLE);
     }
 }
 
@@ -236,11 +233,11 @@ bool LaneChange::processStartSignal(const StartSignal* msg)
 
     if (app->getPlatoonRole() != PlatoonRole::FOLLOWER) return false;
 
-    if (laneChangeManeuverState != LaneChangeManeuverState::PREPARE_LANE_CHANGE || !app->isInManeuver()) return false;
+    if (laneChangeManeuverState != LaneChangeManeuverState::PREPARE_LANE_CHANGE || !app->getManeuverManager()->isActive(this)) return false;
 
     if (nextDestination < 0) return false;
 
-    laneChangeManeuverState = LaneChangeManeuverState::LANE_CHANGE;
+    setState(LaneChangeManeuverState::LANE_CHANGE);
     return true;
 }
 
@@ -250,14 +247,15 @@ void LaneChange::handleStartSignal(const StartSignal* msg)
         plexeTraciVehicle->setFixedLane(nextDestination, false);
         positionHelper->setPlatoonLane(nextDestination);
 
-        laneChangeManeuverState = LaneChangeManeuverState::COMPLETE_LANE_CHANGE;
+        setState(LaneChangeManeuverState::COMPLETE_LANE_CHANGE);
 
         // send response to the leader
         LOG << positionHelper->getId() << " sending laneChanged to the leader (" << msg->getVehicleId() << ")\n";
         LaneChanged* response = new LaneChanged("LaneChanged");
         app->fillManeuverMessage(response, positionHelper->getId(), positionHelper->getExternalId(), positionHelper->getPlatoonId(), msg->getVehicleId());
-        app->sendUnicast(response, msg->getVehicleId());
-    } else {
+        sendUnicast(response, msg->getVehicleId());
+    } else if (app->getManeuverManager()->isActive(this)) {
+        recordAbort(AbortReason::UNEXPECTED_MESSAGE);
         abortManeuver();
     }
 }
@@ -268,7 +266,7 @@ bool LaneChange::processWarnLaneChangeAck(const WarnLaneChangeAck* msg)
 
     if (app->getPlatoonRole() != PlatoonRole::LEADER) return false;
 
-    if (laneChangeManeuverState != LaneChangeManeuverState::WAIT_REPLY || !app->isInManeuver()) return false;
+    if (laneChangeManeuverState != LaneChangeManeuverState::WAIT_REPLY || !app->getManeuverManager()->isActive(this)) return false;
 
     receivedAck[msg->getVehicleId()] = true;
 
@@ -277,8 +275,8 @@ bool LaneChange::processWarnLaneChangeAck(const WarnLaneChangeAck* msg)
         if(!x.second) return false;
     }
 
-    static_cast<LaneChangePlatooningApp*>(app)->resetTimeoutMsg();
-    laneChangeManeuverState = LaneChangeManeuverState::LANE_CHANGE;
+    app->getTimerService()->cancel(timeoutTimer);
+    setState(LaneChangeManeuverState::LANE_CHANGE);
     resetReceivedAck();
     return true;
 }
@@ -302,27 +300,30 @@ int LaneChange::destination()
 void LaneChange::handleWarnLaneChangeAck(const WarnLaneChangeAck* msg)
 {
     if (processWarnLaneChangeAck(msg)) {
-        if (nextDestination >= 0)
+        // another maneuver started during the negotiation might still need
+        // the current lane, or might have added a member that was not warned
+        if (!lockResources(ManeuverManager::LANE, ManeuverManager::LockMode::EXCLUSIVE) || positionHelper->getPlatoonFormation().size() != receivedAck.size() + 1) {
+            LOG << "Leader " << positionHelper->getId() << " aborting the lane change because of a concurrent maneuver\n";
+            recordAbort(AbortReason::CONFLICT);
+            abortManeuver();
+        }
+        else if (nextDestination >= 0)
         {
             plexeTraciVehicle->setFixedLane(nextDestination, false);
             positionHelper->setPlatoonLane(nextDestination);
 
             // send response to followers
-            for (int i: positionHelper->getPlatoonFormation())
-            {
-                if (i != positionHelper->getLeaderId())
-                {
-                    LOG << "Leader " << positionHelper->getId() << " sending startSignal to the follower with id " << i << "\n";
-                    StartSignal* response = new StartSignal("StartSignal");
-                    app->fillManeuverMessage(response, positionHelper->getId(), positionHelper->getExternalId(), positionHelper->getPlatoonId(), i);
-                    app->sendUnicast(response, i);
-                }
-            }
-            laneChangeManeuverState = LaneChangeManeuverState::WAIT_ALL_CHANGED;
-
-            static_cast<LaneChangePlatooningApp*>(app)->sendTimeoutMsg();
-        } else
+            LOG << "Leader " << positionHelper->getId() << " sending startSignal to the followers\n";
+            StartSignal* response = new StartSignal("StartSignal");
+            app->fillManeuverMessage(response, positionHelper->getId(), positionHelper->getExternalId(), positionHelper->getPlatoonId(), -1);
+            sendToGroup(response, getMembersExcept(positionHelper->getLeaderId()));
+            setState(LaneChangeManeuverState::WAIT_ALL_CHANGED);
+
+            app->getTimerService()->arm(timeoutTimer, timeout);
+        } else {
+            recordAbort(AbortReason::UNEXPECTED_MESSAGE);
             abortManeuver();
+        }
     }
 }
 
@@ -332,13 +333,13 @@ bool LaneChange::processWarnLaneChange(const WarnLaneChange* msg)
 
     if (app->getPlatoonRole() != PlatoonRole::FOLLOWER) return false;
 
-    if (laneChangeManeuverState != LaneChangeManeuverState::IDLE || app->isInManeuver()) return false;
+    if (laneChangeManeuverState != LaneChangeManeuverState::IDLE || app->getManeuverManager()->isActive(this)) return false;
 
     if (!isLaneFree(msg->getPlatoonLaneDestination())) return false;
 
-    app->setInManeuver(true, this);
+    if (!lockResources(ManeuverManager::LANE, ManeuverManager::LockMode::EXCLUSIVE)) return false;
 
-    laneChangeManeuverState = LaneChangeManeuverState::PREPARE_LANE_CHANGE;
+    setState(LaneChangeManeuverState::PREPARE_LANE_CHANGE);
     return true;
 }
 
@@ -351,8 +352,9 @@ void LaneChange::handleWarnLaneChange(const WarnLaneChange* msg)
         WarnLaneChangeAck* response = new WarnLaneChangeAck("WarnLaneChangeAck");
         response->setResponse(true);
         app->fillManeuverMessage(response, positionHelper->getId(), positionHelper->getExternalId(), positionHelper->getPlatoonId(), msg->getVehicleId());
-        app->sendUnicast(response, msg->getVehicleId());
+        sendUnicast(response, msg->getVehicleId());
     } else {
+        // the rejection is recorded by the leader when the Abort arrives
         abortManeuver();
     }
 }
@@ -79,7 +79,6 @@ public:
 
     virtual void abortManeuver() override;
     virtual void onFailedTransmissionAttempt(const ManeuverMessage* mm) override;
-    virtual void onManeuverMessage(const ManeuverMessage* mm) override;
     virtual void onPlatoonBeacon(const PlatooningBeacon* pb) override;
 protected:
     /** Possible states a vehicle can be in during a laneChange maneuver */
@@ -97,6 +96,12 @@ protected:
     /** the current state in the laneChange maneuver */
     LaneChangeManeuverState laneChangeManeuverState;
 
+    /** changes the state of the laneChange maneuver, recording the time spent in the previous one */
+    void setState(LaneChangeManeuverState state);
+
+    /** returns the members of the platoon other than the given vehicle */
+    std::vector<int> getMembersExcept(int id);
+
     /** initializes a laneChange maneuver, setting up required data */
     bool initializeLaneChangeManeuver();
 
@@ -123,12 +128,17 @@ private:
 
     bool isLaneFree(int destination);
 
-    virtual bool handleSelfMsg(cMessage* msg) override;
+    /** aborts the maneuver when the other vehicles do not answer in time */
+    void onTimeout();
 
     std::map<int, bool> receivedAck;
     // -1 no destination value
     int nextDestination = -1;
     int securityDistance;
+
+    // time to wait for the answers of the other vehicles, and timer aborting the maneuver
+    const simtime_t timeout = 1;
+    int timeoutTimer;
 };
 
 } // namespace plexe
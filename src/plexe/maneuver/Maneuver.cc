@@ -34,4 +34,89 @@ Maneuver::Maneuver(GeneralPlatooningApp* app)
 {
 }
 
+void Maneuver::onManeuverMessage(const ManeuverMessage* mm)
+{
+    int type = mm->getMessageType();
+    if (type <= UNKNOWN_MANEUVER_MESSAGE || type >= (int) messageHandlers.size() || !messageHandlers[type]) return;
+    messageHandlers[type](mm);
+}
+
+void Maneuver::registerPhases(const std::string& prefix, const std::vector<std::string>& phaseNames)
+{
+    phaseDurationSignals.clear();
+    for (const std::string& name : phaseNames) phaseDurationSignals.push_back(cComponent::registerSignal((prefix + name + "Duration").c_str()));
+    durationSignal = cComponent::registerSignal((prefix + "Duration").c_str());
+    messagesSignal = cComponent::registerSignal((prefix + "Messages").c_str());
+    abortSignal = cComponent::registerSignal((prefix + "Abort").c_str());
+}
+
+void Maneuver::setPhase(int newPhase)
+{
+    if (newPhase == phase) return;
+    ASSERT2(newPhase >= 0 && newPhase < (int) phaseDurationSignals.size(), "maneuver phases not registered or invalid phase");
+
+    simtime_t now = simTime();
+    if (phase == 0) {
+        // a new maneuver starts. keep the messages sent while deciding to start it
+        maneuverStart = now;
+        aborted = false;
+        if (lastIdleSend != now) messagesSent = 0;
+    }
+    else {
+        ManeuverPhaseChange change;
+        change.platoonId = positionHelper->getPlatoonId();
+        change.previousPhase = phase;
+        change.phase = newPhase;
+        change.duration = now - phaseStart;
+        app->emit(phaseDurationSignals[phase], change.duration.dbl(), &change);
+    }
+    if (newPhase == 0) {
+        // the maneuver is over
+        if (!aborted) app->emit(durationSignal, (now - maneuverStart).dbl());
+        app->emit(messagesSignal, (long) messagesSent);
+        messagesSent = 0;
+        lastIdleSend = -1;
+    }
+    phase = newPhase;
+    phaseStart = now;
+}
+
+void Maneuver::recordAbort(AbortReason reason)
+{
+    if (phase == 0 || aborted) return;
+    aborted = true;
+    app->emit(abortSignal, (long) reason);
+}
+
+void Maneuver::countSentMessage()
+{
+    if (phase == 0) {
+        if (lastIdleSend != simTime()) messagesSent = 0;
+        lastIdleSend = simTime();
+    }
+    messagesSent++;
+}
+
+bool Maneuver::lockResources(int resources, ManeuverManager::LockMode mode)
+{
+    return app->getManeuverManager()->lock(this, resources, mode);
+}
+
+void Maneuver::unlockResources()
+{
+    app->getManeuverManager()->unlock(this);
+}
+
+void Maneuver::sendUnicast(cPacket* msg, int destination)
+{
+    countSentMessage();
+    app->sendUnicast(msg, destination);
+}
+
+void Maneuver::sendToGroup(ManeuverMessage* msg, const std::vector<int>& destinations)
+{
+    countSentMessage();
+    app->sendToGroup(msg, destinations);
+}
+
 } // namespace plexe
@@ -25,15 +25,35 @@
 #include "plexe/utilities/BasePositionHelper.h"
 #include "veins/modules/mobility/traci/TraCIMobility.h"
 
+#include "plexe/maneuver/ManeuverManager.h"
 #include "plexe/mobility/CommandInterface.h"
 #include "plexe/messages/ManeuverMessage_m.h"
 #include "plexe/messages/PlatooningBeacon_m.h"
 #include "plexe/messages/UpdatePlatoonFormation_m.h"
 
+#include <functional>
+#include <string>
+#include <vector>
+
 namespace plexe {
 
 class GeneralPlatooningApp;
 
+/**
+ * Details attached to the phase duration signals emitted by a maneuver
+ */
+class ManeuverPhaseChange : public cObject {
+public:
+    /** platoon the vehicle belongs to when the phase ends */
+    int platoonId = -1;
+    /** the phase that ended */
+    int previousPhase = 0;
+    /** the phase that starts */
+    int phase = 0;
+    /** time spent in the phase that ended */
+    simtime_t duration;
+};
+
 class Maneuver {
 
 public:
@@ -59,8 +79,10 @@ public:
     /**
      * This method is invoked by the generic application when a maneuver message is received.
      * The maneuver must not free the memory of the message, as this might be needed by other maneuvers as well.
+     * The default implementation passes the message to the handler registered for its type (see registerMessageHandler()),
+     * ignoring messages of types the maneuver has no handler for.
      */
-    virtual void onManeuverMessage(const ManeuverMessage* mm) = 0;
+    virtual void onManeuverMessage(const ManeuverMessage* mm);
 
     /**
      * This method is invoked by the generic application when a beacon message is received
@@ -84,6 +106,84 @@ public:
         return false;
     }
 
+protected:
+    /** reasons for which a maneuver is aborted, as recorded by the abort signal */
+    enum class AbortReason {
+        OTHER = 0, ///< aborted by the application or for an unspecified reason
+        TIMEOUT, ///< a participant did not answer in time
+        REJECTED, ///< a vehicle refused to take part in the maneuver
+        UNEXPECTED_MESSAGE, ///< a message arrived in the wrong phase
+        ABORT_RECEIVED, ///< another participant aborted the maneuver
+        CONFLICT, ///< the resources needed by the maneuver are in use by another one
+    };
+
+    /**
+     * Registers the signals recording the phases of this maneuver, to be called in the constructor.
+     * Phase 0 must be the idle phase, i.e., the maneuver starts when leaving it and ends when returning to it.
+     * Signal names are built from the prefix: with prefix "laneChange" and phase name "WaitReply" the time spent
+     * in the phase is emitted as laneChangeWaitReplyDuration. The maneuver also emits <prefix>Duration (completion
+     * time of successful maneuvers), <prefix>Messages (messages sent per maneuver), and <prefix>Abort (AbortReason).
+     * Calling this method again replaces the previously registered signals.
+     *
+     * @param prefix prefix of the signal names
+     * @param phaseNames names of the phases, indexed by phase
+     */
+    void registerPhases(const std::string& prefix, const std::vector<std::string>& phaseNames);
+
+    /**
+     * Moves the maneuver to a new phase, emitting the time spent in the previous one.
+     * Subclasses should call this method every time their state changes
+     *
+     * @param newPhase the phase the maneuver enters
+     */
+    void setPhase(int newPhase);
+
+    /**
+     * Records that the current maneuver is being aborted. Only the first reason
+     * is recorded, and nothing is recorded if no maneuver is in progress
+     */
+    void recordAbort(AbortReason reason);
+
+    /**
+     * Locks resources of the vehicle for this maneuver (see ManeuverManager)
+     *
+     * @param resources bitmask of ManeuverManager::Resource
+     * @param mode lock mode
+     * @return true if the resources have been locked, false if another maneuver uses them
+     */
+    bool lockResources(int resources, ManeuverManager::LockMode mode);
+
+    /** unlocks all the resources held by this maneuver */
+    void unlockResources();
+
+    /**
+     * Sends a maneuver message through the application, counting it for the
+     * messages per maneuver statistic
+     */
+    void sendUnicast(cPacket* msg, int destination);
+
+    /**
+     * Sends a maneuver message to a group of vehicles through the application
+     * (see GeneralPlatooningApp::sendToGroup()), counting it as a single message
+     */
+    void sendToGroup(ManeuverMessage* msg, const std::vector<int>& destinations);
+
+    /**
+     * Registers the handler for a type of maneuver message. Maneuvers should register their handlers in the constructor.
+     * When a message of the given type is received, onManeuverMessage() invokes the handler with the message cast to T,
+     * so T must be the class that sets the given type.
+     *
+     * @param type message type (see ManeuverMessageType)
+     * @param handler function taking a const T* as parameter
+     */
+    template <typename T, typename F>
+    void registerMessageHandler(int type, F handler)
+    {
+        ASSERT2(type > UNKNOWN_MANEUVER_MESSAGE, "invalid maneuver message type");
+        if (type >= (int) messageHandlers.size()) messageHandlers.resize(type + 1);
+        messageHandlers[type] = [handler](const ManeuverMessage* mm) { handler(static_cast<const T*>(mm)); };
+    }
+
 protected:
     GeneralPlatooningApp* app;
     BasePositionHelper* positionHelper;
@@ -92,6 +192,31 @@ protected:
     veins::TraCICommandInterface::Vehicle* traciVehicle;
     traci::CommandInterface* plexeTraci;
     traci::CommandInterface::Vehicle* plexeTraciVehicle;
+
+private:
+    // message handlers indexed by message type
+    std::vector<std::function<void(const ManeuverMessage*)>> messageHandlers;
+
+    // current phase and time at which it started
+    int phase = 0;
+    simtime_t phaseStart;
+    // time at which the current maneuver started
+    simtime_t maneuverStart;
+    // whether the current maneuver has been aborted
+    bool aborted = false;
+    // messages sent during the current maneuver, and time of the last one
+    // sent while idle, which counts for the maneuver starting in the same event
+    int messagesSent = 0;
+    simtime_t lastIdleSend = -1;
+
+    // signals emitting the duration of each phase, indexed by phase
+    std::vector<simsignal_t> phaseDurationSignals;
+    simsignal_t durationSignal = -1;
+    simsignal_t messagesSignal = -1;
+    simsignal_t abortSignal = -1;
+
+    /** counts a message sent for the messages per maneuver statistic */
+    void countSentMessage();
 };
 
 } // namespace plexe
@@ -0,0 +1,131 @@
+//
+// Copyright (C) 2021 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "plexe/maneuver/ManeuverManager.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "plexe/plexe.h"
+
+namespace plexe {
+
+namespace {
+
+// returns the resource with the given name, as used by the conflict rules
+int parseResource(const std::string& name)
+{
+    if (name == "lane") return ManeuverManager::LANE;
+    if (name == "tail") return ManeuverManager::FORMATION_TAIL;
+    if (name == "role") return ManeuverManager::LEADER_ROLE;
+    throw omnetpp::cRuntimeError("Invalid maneuver resource \"%s\" in conflict rules", name.c_str());
+}
+
+} // namespace
+
+ManeuverManager::ManeuverManager()
+{
+    std::fill(conflicts, conflicts + nResources, 0);
+}
+
+void ManeuverManager::addManeuver(Maneuver* maneuver)
+{
+    maneuvers.push_back(maneuver);
+}
+
+void ManeuverManager::parseConflicts(const std::string& rules)
+{
+    std::istringstream in(rules);
+    std::string rule;
+    while (in >> rule) {
+        size_t separator = rule.find(':');
+        if (separator == std::string::npos) throw omnetpp::cRuntimeError("Invalid maneuver conflict rule \"%s\", expected resource:resource", rule.c_str());
+        addConflict(parseResource(rule.substr(0, separator)), parseResource(rule.substr(separator + 1)));
+    }
+}
+
+void ManeuverManager::addConflict(int a, int b)
+{
+    for (int i = 0; i < nResources; i++) {
+        if (a & (1 << i)) conflicts[i] |= b;
+        if (b & (1 << i)) conflicts[i] |= a;
+    }
+}
+
+int ManeuverManager::getConflicts(int resources) const
+{
+    int result = 0;
+    for (int i = 0; i < nResources; i++)
+        if (resources & (1 << i)) result |= conflicts[i];
+    return result;
+}
+
+bool ManeuverManager::canLock(const Maneuver* maneuver, int resources, LockMode mode) const
+{
+    int conflicting = getConflicts(resources);
+    for (const Lock& lock : locks) {
+        if (lock.maneuver == maneuver) continue;
+        int held = lock.shared | lock.exclusive;
+        if (held & conflicting) return false;
+        // shared locks are compatible with each other, exclusive ones with nothing
+        if (mode == LockMode::EXCLUSIVE && (held & resources)) return false;
+        if (mode == LockMode::SHARED && (lock.exclusive & resources)) return false;
+    }
+    return true;
+}
+
+bool ManeuverManager::lock(Maneuver* maneuver, int resources, LockMode mode)
+{
+    ASSERT2(maneuver, "only maneuvers can lock resources");
+    if (!canLock(maneuver, resources, mode)) return false;
+
+    auto lock = std::find_if(locks.begin(), locks.end(), [maneuver](const Lock& l) { return l.maneuver == maneuver; });
+    if (lock == locks.end()) {
+        locks.push_back({maneuver, 0, 0});
+        lock = locks.end() - 1;
+    }
+    if (mode == LockMode::EXCLUSIVE) {
+        lock->exclusive |= resources;
+        lock->shared &= ~resources;
+    }
+    else {
+        lock->shared |= resources & ~lock->exclusive;
+    }
+    return true;
+}
+
+void ManeuverManager::unlock(const Maneuver* maneuver)
+{
+    locks.erase(std::remove_if(locks.begin(), locks.end(), [maneuver](const Lock& l) { return l.maneuver == maneuver; }), locks.end());
+}
+
+bool ManeuverManager::isActive(const Maneuver* maneuver) const
+{
+    return std::any_of(locks.begin(), locks.end(), [maneuver](const Lock& l) { return l.maneuver == maneuver; });
+}
+
+std::vector<Maneuver*> ManeuverManager::getActiveManeuvers() const
+{
+    std::vector<Maneuver*> active;
+    for (const Lock& lock : locks) active.push_back(lock.maneuver);
+    return active;
+}
+
+} // namespace plexe
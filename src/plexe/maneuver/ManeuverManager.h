@@ -0,0 +1,142 @@
+//
+// Copyright (C) 2021 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#ifndef MANEUVERMANAGER_H_
+#define MANEUVERMANAGER_H_
+
+#include <string>
+#include <vector>
+
+namespace plexe {
+
+class Maneuver;
+
+/**
+ * Keeps track of the maneuvers of a vehicle and of the resources they use,
+ * so that several maneuvers can run at the same time as long as they do not
+ * interfere. A maneuver locks the resources it needs before starting (or
+ * before accepting to take part in a maneuver started by another vehicle)
+ * and unlocks them when it is over.
+ *
+ * A resource can be locked in shared mode by several maneuvers, e.g., to
+ * make sure the platoon keeps its lane, or in exclusive mode by a single
+ * maneuver, e.g., to actually move the platoon to another lane. On top of
+ * that, conflict rules forbid two resources to be locked by two different
+ * maneuvers at the same time, whatever the mode.
+ */
+class ManeuverManager {
+public:
+    /** resources a maneuver can lock, to be combined as a bitmask */
+    enum Resource {
+        LANE = 1 << 0, ///< the lane of the vehicle, and of its platoon for the leader
+        FORMATION_TAIL = 1 << 1, ///< the back of the platoon, where new members are added
+        LEADER_ROLE = 1 << 2, ///< the role of the vehicle in its platoon
+    };
+
+    /** lock modes */
+    enum class LockMode {
+        SHARED, ///< other maneuvers can lock the resource in shared mode as well
+        EXCLUSIVE, ///< no other maneuver can lock the resource
+    };
+
+    ManeuverManager();
+
+    /**
+     * Adds a maneuver to the ones of this vehicle, which are notified about
+     * messages, beacons, and self messages in the order they are added
+     */
+    void addManeuver(Maneuver* maneuver);
+
+    /** returns the maneuvers of this vehicle */
+    const std::vector<Maneuver*>& getManeuvers() const
+    {
+        return maneuvers;
+    }
+
+    /**
+     * Adds the conflict rules in the given string, as a space separated list
+     * of resource pairs, e.g., "lane:tail role:tail". Resources are named
+     * lane, tail, and role
+     */
+    void parseConflicts(const std::string& rules);
+
+    /** forbids two different maneuvers to lock a and b at the same time */
+    void addConflict(int a, int b);
+
+    /**
+     * Returns whether a maneuver could lock the given resources. Locks held
+     * by the maneuver itself are not considered, so a maneuver can upgrade a
+     * shared lock to an exclusive one. Pass nullptr for a maneuver not
+     * holding any lock
+     *
+     * @param maneuver the maneuver that wants to lock the resources
+     * @param resources bitmask of resources to lock
+     * @param mode lock mode
+     */
+    bool canLock(const Maneuver* maneuver, int resources, LockMode mode) const;
+
+    /**
+     * Locks the given resources for a maneuver, if possible
+     *
+     * @return true if the resources have been locked, false if they are in
+     * use by another maneuver, in which case nothing is locked
+     */
+    bool lock(Maneuver* maneuver, int resources, LockMode mode);
+
+    /** unlocks all the resources held by a maneuver */
+    void unlock(const Maneuver* maneuver);
+
+    /** returns whether a maneuver holds any lock */
+    bool isActive(const Maneuver* maneuver) const;
+
+    /** returns whether any maneuver holds a lock */
+    bool isInManeuver() const
+    {
+        return !locks.empty();
+    }
+
+    /** returns the maneuvers currently holding a lock */
+    std::vector<Maneuver*> getActiveManeuvers() const;
+
+private:
+    /** resources locked by a maneuver */
+    struct Lock {
+        Maneuver* maneuver;
+        int shared;
+        int exclusive;
+    };
+
+    /** number of resources */
+    static const int nResources = 3;
+
+    /** all the maneuvers of this vehicle */
+    std::vector<Maneuver*> maneuvers;
+    /** locks of the active maneuvers. only a handful of maneuvers run at the same time */
+    std::vector<Lock> locks;
+    /** for each resource, the resources it conflicts with besides itself */
+    int conflicts[nResources];
+
+    /** returns the resources conflicting with the given ones, whatever the lock mode */
+    int getConflicts(int resources) const;
+};
+
+} // namespace plexe
+
+#endif
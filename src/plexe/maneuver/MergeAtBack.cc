@@ -26,14 +26,9 @@ namespace plexe {
 MergeAtBack::MergeAtBack(GeneralPlatooningApp* app)
     : JoinAtBack(app)
     , oldPlatoonId(-1)
-    , checkDistance(new cMessage("checkDistance"))
 {
-}
-
-MergeAtBack::~MergeAtBack()
-{
-    delete checkDistance;
-    checkDistance = nullptr;
+    registerJoinPhases("merge");
+    checkDistanceTimer = app->getTimerService()->registerTimer("mergeCheckDistance", [this]() { checkDistance(); });
 }
 
 void MergeAtBack::startManeuver(const void* parameters)
@@ -51,7 +46,7 @@ void MergeAtBack::startManeuver(const void* parameters)
         // send merge request to leader
         LOG << positionHelper->getId() << " sending MergePlatoonRequest to platoon with id " << targetPlatoonData->platoonId << " (leader id " << targetPlatoonData->platoonLeader << ")\n";
         MergePlatoonRequest* req = createMergePlatoonRequest(positionHelper->getId(), positionHelper->getExternalId(), targetPlatoonData->platoonId, targetPlatoonData->platoonLeader, traciVehicle->getLaneIndex(), mobility->getPositionAt(simTime()).x, mobility->getPositionAt(simTime()).y, members);
-        app->sendUnicast(req, targetPlatoonData->platoonLeader);
+        sendUnicast(req, targetPlatoonData->platoonLeader);
     }
 }
 
@@ -71,36 +66,30 @@ void MergeAtBack::handleMergePlatoonRequest(const MergePlatoonRequest* msg)
         }
         LOG << positionHelper->getId() << " sending MoveToPosition to vehicle with id " << msg->getVehicleId() << "\n";
         MoveToPosition* mtp = createMoveToPosition(positionHelper->getId(), positionHelper->getExternalId(), positionHelper->getPlatoonId(), joinerData->joinerId, positionHelper->getPlatoonSpeed(), positionHelper->getPlatoonLane(), joinerData->newFormation);
-        app->sendUnicast(mtp, joinerData->joinerId);
+        sendUnicast(mtp, joinerData->joinerId);
     }
 }
 
 void MergeAtBack::handleJoinFormation(const JoinFormation* msg)
 {
-    // when we are allowed to join the platoon, periodically check the distance to the front vehicle
-    app->scheduleAt(simTime() + 0.5, checkDistance);
+    JoinManeuverState previousState = joinManeuverState;
     JoinAtBack::handleJoinFormation(msg);
+    // the message is meant for this maneuver only if it completed the join.
+    // in that case, periodically check the distance to the front vehicle
+    if (previousState == JoinManeuverState::J_WAIT_JOIN && joinManeuverState == JoinManeuverState::IDLE) app->getTimerService()->arm(checkDistanceTimer, 0.5);
 }
 
-bool MergeAtBack::handleSelfMsg(cMessage* msg)
+void MergeAtBack::checkDistance()
 {
-    if (msg == checkDistance) {
-        double distance, relativeSpeed;
-        plexeTraciVehicle->getRadarMeasurements(distance, relativeSpeed);
-        // we are close enough to the front platoon. tell the followers to change the platoon composition
-        if (distance < app->getTargetDistance(targetPlatoonData->platoonSpeed) + 1) {
-            for (unsigned int i = 1; i < oldFormation.size(); i++) {
-                UpdatePlatoonData* mm = app->createUpdatePlatoonData(positionHelper->getId(), positionHelper->getExternalId(), oldPlatoonId, oldFormation[i], targetPlatoonData->platoonSpeed, targetPlatoonData->platoonLane, targetPlatoonData->newFormation, targetPlatoonData->platoonId);
-                app->sendUnicast(mm, oldFormation[i]);
-            }
-        }
-        else {
-            app->scheduleAt(simTime() + 0.5, checkDistance);
-        }
-        return true;
+    double distance, relativeSpeed;
+    plexeTraciVehicle->getRadarMeasurements(distance, relativeSpeed);
+    // we are close enough to the front platoon. tell the followers to change the platoon composition
+    if (distance < app->getTargetDistance(targetPlatoonData->platoonSpeed) + 1) {
+        UpdatePlatoonData* mm = app->createUpdatePlatoonData(positionHelper->getId(), positionHelper->getExternalId(), oldPlatoonId, -1, targetPlatoonData->platoonSpeed, targetPlatoonData->platoonLane, targetPlatoonData->newFormation, targetPlatoonData->platoonId);
+        sendToGroup(mm, std::vector<int>(oldFormation.begin() + 1, oldFormation.end()));
     }
     else {
-        return false;
+        app->getTimerService()->arm(checkDistanceTimer, 0.5);
     }
 }
 
@@ -119,15 +108,12 @@ void MergeAtBack::handleJoinFormationAck(const JoinFormationAck* msg)
     positionHelper->setPlatoonFormation(joinerData->newFormation);
 
     // send to all vehicles in Platoon
-    for (unsigned int i = 1; i < positionHelper->getPlatoonSize(); i++) {
-        UpdatePlatoonFormation* dup = app->createUpdatePlatoonFormation(positionHelper->getId(), positionHelper->getExternalId(), positionHelper->getPlatoonId(), -1, positionHelper->getPlatoonSpeed(), traciVehicle->getLaneIndex(), joinerData->newFormation);
-        int dest = positionHelper->getMemberId(i);
-        dup->setDestinationId(dest);
-        app->sendUnicast(dup, dest);
-    }
+    const std::vector<int>& formation = positionHelper->getPlatoonFormation();
+    UpdatePlatoonFormation* upf = app->createUpdatePlatoonFormation(positionHelper->getId(), positionHelper->getExternalId(), positionHelper->getPlatoonId(), -1, positionHelper->getPlatoonSpeed(), traciVehicle->getLaneIndex(), joinerData->newFormation);
+    sendToGroup(upf, std::vector<int>(formation.begin() + 1, formation.end()));
 
-    joinManeuverState = JoinManeuverState::IDLE;
-    app->setInManeuver(false, nullptr);
+    setState(JoinManeuverState::IDLE);
+    unlockResources();
 }
 
 } // namespace plexe
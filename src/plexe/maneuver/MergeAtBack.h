@@ -38,7 +38,7 @@ public:
      * @param app pointer to the generic application used to fetch parameters and inform it about a concluded maneuver
      */
     MergeAtBack(GeneralPlatooningApp* app);
-    virtual ~MergeAtBack();
+    virtual ~MergeAtBack(){};
 
     /**
      * This method is invoked by the generic application to start the maneuver
@@ -75,16 +75,17 @@ public:
      */
     virtual void handleJoinFormationAck(const JoinFormationAck* msg) override;
 
-    virtual bool handleSelfMsg(cMessage* msg) override;
-
 protected:
     // store the old formation this vehicle is leader for to communicate it to the leader of the platoon we are merging with
     std::vector<int> oldFormation;
     // store the old platoon id before changing it
     int oldPlatoonId;
 
-    // message used to periodically check for the distance while performing the final approach
-    cMessage* checkDistance;
+    // timer used to periodically check for the distance while performing the final approach
+    int checkDistanceTimer;
+
+    /** checks the distance to the front vehicle, telling the followers to join the new platoon when close enough */
+    void checkDistance();
 };
 
 } // namespace plexe
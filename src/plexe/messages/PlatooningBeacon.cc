@@ -0,0 +1,69 @@
+//
+// Copyright (C) 2012-2021 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "plexe/messages/PlatooningBeacon_m.h"
+
+#include <vector>
+
+Register_Class(PlatooningBeacon);
+
+namespace {
+
+// maximum number of free beacons kept for reuse. beyond this, memory is
+// returned to the heap, so a burst of beacons does not stay allocated
+const size_t maxFreeBeacons = 4096;
+
+/**
+ * Memory of deleted beacons, ready to be used for new ones. Only the exact
+ * size of a PlatooningBeacon is pooled, subclasses use the heap as usual.
+ * The pool is never destroyed, so beacons deleted during the teardown of
+ * the simulation can still be returned to it. Its capacity is reserved
+ * upfront, so returning a beacon never allocates
+ */
+std::vector<void*>& freeBeacons()
+{
+    static std::vector<void*>* beacons = [] {
+        std::vector<void*>* pool = new std::vector<void*>();
+        pool->reserve(maxFreeBeacons);
+        return pool;
+    }();
+    return *beacons;
+}
+
+} // namespace
+
+void* PlatooningBeacon::operator new(size_t size)
+{
+    std::vector<void*>& beacons = freeBeacons();
+    if (size != sizeof(PlatooningBeacon) || beacons.empty()) return ::operator new(size);
+    void* p = beacons.back();
+    beacons.pop_back();
+    return p;
+}
+
+void PlatooningBeacon::operator delete(void* p, size_t size)
+{
+    std::vector<void*>& beacons = freeBeacons();
+    if (size != sizeof(PlatooningBeacon) || beacons.size() >= maxFreeBeacons) {
+        ::operator delete(p);
+        return;
+    }
+    beacons.push_back(p);
+}
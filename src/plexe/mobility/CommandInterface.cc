@@ -22,30 +22,138 @@
 
 #include <veins/modules/mobility/traci/TraCIConnection.h>
 #include <veins/modules/mobility/traci/TraCIConstants.h>
-#include <veins/modules/mobility/traci/ParBuffer.h>
 
-using veins::ParBuffer;
+#include <algorithm>
+#include <sstream>
+
 using veins::TraCIBuffer;
 using namespace veins::TraCIConstants;
 
 namespace plexe {
 namespace traci {
 
-CommandInterface::CommandInterface(cComponent* owner, veins::TraCICommandInterface* veinsCommandInterface, veins::TraCIConnection* connection)
+CommandInterface::CommandInterface(cComponent* owner, veins::TraCICommandInterface* veinsCommandInterface, veins::TraCIConnection* connection, bool batchCommands)
     : HasLogProxy(owner)
     , veinsCommandInterface(veinsCommandInterface)
     , connection(connection)
+    , batchCommands(batchCommands)
+    , collectStatistics(false)
+    , roundTrips(0)
+    , callDepth(0)
+{
+}
+
+CommandInterface::ApiCall::ApiCall(CommandInterface* cifc, const char* api)
+    : cifc(cifc)
+    , api(api)
+    , outermost(cifc->collectStatistics && cifc->callDepth == 0)
+{
+    cifc->callDepth++;
+    if (!outermost) return;
+    startRoundTrips = cifc->roundTrips;
+    start = std::chrono::steady_clock::now();
+}
+
+CommandInterface::ApiCall::~ApiCall()
+{
+    cifc->callDepth--;
+    if (!outermost) return;
+    double latency = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // calls are split by the class of the module invoking the API
+    cModule* caller = getSimulation()->getContextModule();
+    ApiStatisticsKey key(api, caller ? caller->getClassName() : "");
+    auto statistics = cifc->apiStatistics.find(key);
+    if (statistics == cifc->apiStatistics.end()) statistics = cifc->apiStatistics.emplace(key, ApiStatistics()).first;
+    statistics->second.calls++;
+    statistics->second.roundTrips += cifc->roundTrips - startRoundTrips;
+    statistics->second.latency.collect(latency);
+}
+
+CommandInterface::ApiStatistics::ApiStatistics()
+    : calls(0)
+    , roundTrips(0)
+{
+}
+
+void CommandInterface::recordStatistics(cComponent* component)
+{
+    for (auto& statistics : apiStatistics) {
+        std::string name = statistics.first.first + " from " + statistics.first.second;
+        component->recordScalar((name + " calls").c_str(), statistics.second.calls);
+        component->recordScalar((name + " roundTrips").c_str(), statistics.second.roundTrips);
+        const LogLinearHistogram& latency = statistics.second.latency;
+        component->recordScalar((name + " meanLatency").c_str(), latency.getMean(), "s");
+        component->recordScalar((name + " latencyP50").c_str(), latency.getQuantile(0.5), "s");
+        component->recordScalar((name + " latencyP95").c_str(), latency.getQuantile(0.95), "s");
+        component->recordScalar((name + " latencyP99").c_str(), latency.getQuantile(0.99), "s");
+        component->recordScalar((name + " maxLatency").c_str(), latency.getMax(), "s");
+    }
+    component->recordScalar("traciRoundTrips", roundTrips);
+    if (simTime() > 0) component->recordScalar("traciRoundTripsPerSecond", roundTrips / simTime().dbl());
+}
+
+void CommandInterface::logStatistics()
 {
+    for (const auto& statistics : apiStatistics) {
+        const ApiStatistics& s = statistics.second;
+        EV_INFO << statistics.first.first << " from " << statistics.first.second << ": " << s.calls << " calls, " << s.roundTrips << " round trips, latency mean " << s.latency.getMean() << "s, P50 " << s.latency.getQuantile(0.5) << "s, P95 " << s.latency.getQuantile(0.95) << "s, P99 " << s.latency.getQuantile(0.99) << "s, max " << s.latency.getMax() << "s\n";
+    }
+    EV_INFO << "total TraCI round trips: " << roundTrips << "\n";
 }
 
 double CommandInterface::Vehicle::getMinNeighDistance(uint8_t direction, uint8_t longitudinalDirection)
 {
-    TraCIBuffer response = cifc->connection->query(CMD_GET_VEHICLE_VARIABLE, TraCIBuffer()
-            << static_cast<uint8_t>(0xBF) << nodeId
-            << static_cast<uint8_t>(TYPE_UBYTE) << static_cast<uint8_t>(0b000 | longitudinalDirection<<1 | direction));
+    ApiCall call(cifc, "getMinNeighDistance");
+    TraCIBuffer response = cifc->query(CMD_GET_VEHICLE_VARIABLE, cifc->neighboursQuery(nodeId, direction, longitudinalDirection));
+    return cifc->readMinNeighDistance(response);
+}
+
+CommandInterface::LaneGapInfo CommandInterface::Vehicle::getLaneGapInfo(int direction)
+{
+    ApiCall call(cifc, "getLaneGapInfo");
+    std::vector<std::pair<uint8_t, TraCIBuffer>> queries;
+    cifc->laneGapQueries(queries, nodeId, direction);
+    TraCIBuffer response = cifc->query(queries);
+    LaneGapInfo info = cifc->readLaneGapInfo(response);
+    ASSERT(response.eof());
+    return info;
+}
+
+TraCIBuffer CommandInterface::neighboursQuery(const std::string& nodeId, uint8_t direction, uint8_t longitudinalDirection)
+{
+    return TraCIBuffer() << static_cast<uint8_t>(0xBF) << nodeId << static_cast<uint8_t>(TYPE_UBYTE) << static_cast<uint8_t>(0b000 | longitudinalDirection << 1 | direction);
+}
+
+void CommandInterface::laneGapQueries(std::vector<std::pair<uint8_t, TraCIBuffer>>& queries, const std::string& nodeId, int direction)
+{
+    // lateral direction of the neighbours query is 0 for left and 1 for right
+    uint8_t side = direction > 0 ? 0 : 1;
+    queries.push_back({CMD_GET_VEHICLE_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(CMD_CHANGELANE) << nodeId << static_cast<uint8_t>(TYPE_INTEGER) << direction});
+    queries.push_back({CMD_GET_VEHICLE_VARIABLE, neighboursQuery(nodeId, side, 0)});
+    queries.push_back({CMD_GET_VEHICLE_VARIABLE, neighboursQuery(nodeId, side, 1)});
+}
+
+CommandInterface::LaneGapInfo CommandInterface::readLaneGapInfo(TraCIBuffer& response)
+{
+    LaneGapInfo info;
+    checkStatus(response, CMD_GET_VEHICLE_VARIABLE);
+    readLaneChangeState(response, info.state, info.state2);
+    checkStatus(response, CMD_GET_VEHICLE_VARIABLE);
+    info.minBack = readMinNeighDistance(response);
+    checkStatus(response, CMD_GET_VEHICLE_VARIABLE);
+    info.minFront = readMinNeighDistance(response);
+    return info;
+}
 
+double CommandInterface::readMinNeighDistance(TraCIBuffer& response)
+{
     uint8_t cmdLength;
     response >> cmdLength;
+    if (cmdLength == 0) {
+        uint32_t cmdLengthExt;
+        response >> cmdLengthExt;
+    }
     uint8_t responseId;
     response >> responseId;
     ASSERT(responseId == RESPONSE_GET_VEHICLE_VARIABLE);
@@ -76,163 +184,174 @@ double CommandInterface::Vehicle::getMinNeighDistance(uint8_t direction, uint8_t
 
 void CommandInterface::Vehicle::setLaneChangeMode(int mode)
 {
+    ApiCall call(cifc, "setLaneChangeMode");
     uint8_t variableId = VAR_LANECHANGE_MODE;
     uint8_t type = TYPE_INTEGER;
-    TraCIBuffer buf = cifc->connection->query(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << type << mode);
-    ASSERT(buf.eof());
+    cifc->sendCommand(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << type << mode);
 }
 
 void CommandInterface::Vehicle::getLaneChangeState(int direction, int& state1, int& state2)
 {
-    TraCIBuffer response = cifc->connection->query(CMD_GET_VEHICLE_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(CMD_CHANGELANE) << nodeId << static_cast<uint8_t>(TYPE_INTEGER) << direction);
-    uint8_t cmdLength;
-    response >> cmdLength;
-    uint8_t responseId;
-    response >> responseId;
-    ASSERT(responseId == RESPONSE_GET_VEHICLE_VARIABLE);
-    uint8_t variable;
-    response >> variable;
-    ASSERT(variable == CMD_CHANGELANE);
-    std::string id;
-    response >> id;
-    uint8_t type;
-    response >> type;
-    ASSERT(type == TYPE_COMPOUND);
-    int count;
-    response >> count;
-    ASSERT(count == 2);
-    response >> type;
-    ASSERT(type == TYPE_INTEGER);
-    response >> state1;
-    response >> type;
-    ASSERT(type == TYPE_INTEGER);
-    response >> state2;
+    ApiCall call(cifc, "getLaneChangeState");
+    TraCIBuffer response = cifc->query(CMD_GET_VEHICLE_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(CMD_CHANGELANE) << nodeId << static_cast<uint8_t>(TYPE_INTEGER) << direction);
+    cifc->readLaneChangeState(response, state1, state2);
 }
 
 void CommandInterface::Vehicle::changeLane(int lane, double duration)
 {
+    ApiCall call(cifc, "changeLane");
     uint8_t commandType = TYPE_COMPOUND;
     int nParameters = 2;
     uint8_t variableId = CMD_CHANGELANE;
-    TraCIBuffer buf = cifc->connection->query(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << commandType << nParameters << static_cast<uint8_t>(TYPE_BYTE) << (uint8_t) lane << static_cast<uint8_t>(TYPE_DOUBLE) << duration);
-    ASSERT(buf.eof());
+    cifc->sendCommand(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << commandType << nParameters << static_cast<uint8_t>(TYPE_BYTE) << (uint8_t) lane << static_cast<uint8_t>(TYPE_DOUBLE) << duration);
 }
 
 void CommandInterface::Vehicle::setLeaderVehicleData(double controllerAcceleration, double acceleration, double speed, double positionX, double positionY, double time)
 {
-    ParBuffer buf;
+    ApiCall call(cifc, "setLeaderVehicleData");
+    ParameterBuffer& buf = cifc->parameterBuffer;
+    buf.clear();
     buf << speed << acceleration << positionX << positionY << time << controllerAcceleration;
-    veinsVehicle().setParameter(PAR_LEADER_SPEED_AND_ACCELERATION, buf.str());
+    cifc->setCoalescedParameter(nodeId, PAR_LEADER_SPEED_AND_ACCELERATION, -1, buf.str());
 }
 
 void CommandInterface::Vehicle::setPlatoonLeaderData(double speed, double acceleration, double positionX, double positionY, double time)
 {
+    ApiCall call(cifc, "setPlatoonLeaderData");
     std::cout << "setPlatoonLeaderData() is deprecated and will be removed. Please use setLeaderVehicleData()\n";
     setLeaderVehicleData(acceleration, acceleration, speed, positionX, positionY, time);
 }
 
 void CommandInterface::Vehicle::setFrontVehicleData(double controllerAcceleration, double acceleration, double speed, double positionX, double positionY, double time)
 {
-    ParBuffer buf;
+    ApiCall call(cifc, "setFrontVehicleData");
+    ParameterBuffer& buf = cifc->parameterBuffer;
+    buf.clear();
     buf << speed << acceleration << positionX << positionY << time << controllerAcceleration;
-    veinsVehicle().setParameter(PAR_PRECEDING_SPEED_AND_ACCELERATION, buf.str());
+    cifc->setCoalescedParameter(nodeId, PAR_PRECEDING_SPEED_AND_ACCELERATION, -1, buf.str());
 }
 
 void CommandInterface::Vehicle::getVehicleData(double& speed, double& acceleration, double& controllerAcceleration, double& positionX, double& positionY, double& time)
 {
-    std::string v;
-    veinsVehicle().getParameter(PAR_SPEED_AND_ACCELERATION, v);
-    ParBuffer buf(v);
-    buf >> speed >> acceleration >> controllerAcceleration >> positionX >> positionY >> time;
+    ApiCall call(cifc, "getVehicleData");
+    const VEHICLE_DATA& state = cifc->getVehicleState(nodeId).data;
+    speed = state.speed;
+    acceleration = state.acceleration;
+    controllerAcceleration = state.u;
+    positionX = state.positionX;
+    positionY = state.positionY;
+    time = state.time;
 }
 
 void CommandInterface::Vehicle::getVehicleData(VEHICLE_DATA* data)
 {
-    std::string v;
-    veinsVehicle().getParameter(PAR_SPEED_AND_ACCELERATION, v);
-    ParBuffer buf(v);
-    buf >> data->speed >> data->acceleration >> data->u >> data->positionX >> data->positionY >> data->time >> data->speedX >> data->speedY >> data->angle;
+    ApiCall call(cifc, "getVehicleData");
+    // only copy the fields provided by sumo, leaving index and length untouched
+    const VEHICLE_DATA& state = cifc->getVehicleState(nodeId).data;
+    data->speed = state.speed;
+    data->acceleration = state.acceleration;
+    data->u = state.u;
+    data->positionX = state.positionX;
+    data->positionY = state.positionY;
+    data->time = state.time;
+    data->speedX = state.speedX;
+    data->speedY = state.speedY;
+    data->angle = state.angle;
 }
 
 void CommandInterface::Vehicle::setCruiseControlDesiredSpeed(double desiredSpeed)
 {
-    veinsVehicle().setParameter(PAR_CC_DESIRED_SPEED, desiredSpeed);
+    ApiCall call(cifc, "setCruiseControlDesiredSpeed");
+    setParameter(PAR_CC_DESIRED_SPEED, desiredSpeed);
 }
 
 const double CommandInterface::Vehicle::getCruiseControlDesiredSpeed()
 {
+    ApiCall call(cifc, "getCruiseControlDesiredSpeed");
     double desiredSpeed;
-    veinsVehicle().getParameter(PAR_CC_DESIRED_SPEED, desiredSpeed);
+    getParameter(PAR_CC_DESIRED_SPEED, desiredSpeed);
     return desiredSpeed;
 }
 
 void CommandInterface::Vehicle::setActiveController(int activeController)
 {
-    veinsVehicle().setParameter(PAR_ACTIVE_CONTROLLER, activeController);
+    ApiCall call(cifc, "setActiveController");
+    setParameter(PAR_ACTIVE_CONTROLLER, activeController);
 }
 
 int CommandInterface::Vehicle::getActiveController()
 {
+    ApiCall call(cifc, "getActiveController");
     int v;
-    veinsVehicle().getParameter(PAR_ACTIVE_CONTROLLER, v);
+    getParameter(PAR_ACTIVE_CONTROLLER, v);
     return v;
 }
 
 void CommandInterface::Vehicle::setCACCConstantSpacing(double spacing)
 {
-    veinsVehicle().setParameter(PAR_CACC_SPACING, spacing);
+    ApiCall call(cifc, "setCACCConstantSpacing");
+    setParameter(PAR_CACC_SPACING, spacing);
 }
 
 double CommandInterface::Vehicle::getCACCConstantSpacing()
 {
+    ApiCall call(cifc, "getCACCConstantSpacing");
     double v;
-    veinsVehicle().getParameter(PAR_CACC_SPACING, v);
+    getParameter(PAR_CACC_SPACING, v);
     return v;
 }
 
 void CommandInterface::Vehicle::setPathCACCParameters(double omegaN, double xi, double c1, double distance)
 {
-    if (omegaN >= 0) veinsVehicle().setParameter(CC_PAR_CACC_OMEGA_N, omegaN);
-    if (xi >= 0) veinsVehicle().setParameter(CC_PAR_CACC_XI, xi);
-    if (c1 >= 0) veinsVehicle().setParameter(CC_PAR_CACC_C1, c1);
-    if (distance >= 0) veinsVehicle().setParameter(PAR_CACC_SPACING, distance);
+    ApiCall call(cifc, "setPathCACCParameters");
+    if (omegaN >= 0) setParameter(CC_PAR_CACC_OMEGA_N, omegaN);
+    if (xi >= 0) setParameter(CC_PAR_CACC_XI, xi);
+    if (c1 >= 0) setParameter(CC_PAR_CACC_C1, c1);
+    if (distance >= 0) setParameter(PAR_CACC_SPACING, distance);
 }
 
 void CommandInterface::Vehicle::setPloegCACCParameters(double kp, double kd, double h)
 {
-    if (kp >= 0) veinsVehicle().setParameter(CC_PAR_PLOEG_KP, kp);
-    if (kd >= 0) veinsVehicle().setParameter(CC_PAR_PLOEG_KD, kd);
-    if (h >= 0) veinsVehicle().setParameter(CC_PAR_PLOEG_H, h);
+    ApiCall call(cifc, "setPloegCACCParameters");
+    if (kp >= 0) setParameter(CC_PAR_PLOEG_KP, kp);
+    if (kd >= 0) setParameter(CC_PAR_PLOEG_KD, kd);
+    if (h >= 0) setParameter(CC_PAR_PLOEG_H, h);
 }
 
 void CommandInterface::Vehicle::setACCHeadwayTime(double headway)
 {
-    veinsVehicle().setParameter(PAR_ACC_HEADWAY_TIME, headway);
+    ApiCall call(cifc, "setACCHeadwayTime");
+    setParameter(PAR_ACC_HEADWAY_TIME, headway);
 }
 
 double CommandInterface::Vehicle::getACCHeadwayTime()
 {
+    ApiCall call(cifc, "getACCHeadwayTime");
     double headway;
-    veinsVehicle().getParameter(PAR_ACC_HEADWAY_TIME, headway);
+    getParameter(PAR_ACC_HEADWAY_TIME, headway);
     return headway;
 }
 
 void CommandInterface::Vehicle::setFixedAcceleration(int activate, double acceleration)
 {
-    ParBuffer buf;
+    ApiCall call(cifc, "setFixedAcceleration");
+    ParameterBuffer& buf = cifc->parameterBuffer;
+    buf.clear();
     buf << activate << acceleration;
-    veinsVehicle().setParameter(PAR_FIXED_ACCELERATION, buf.str());
+    setParameter(PAR_FIXED_ACCELERATION, buf.str());
 }
 
 bool CommandInterface::Vehicle::isCrashed()
 {
+    ApiCall call(cifc, "isCrashed");
     int crashed;
-    veinsVehicle().getParameter(PAR_CRASHED, crashed);
+    getParameter(PAR_CRASHED, crashed);
     return crashed;
 }
 
 void CommandInterface::Vehicle::setFixedLane(int8_t laneIndex, bool safe)
 {
+    ApiCall call(cifc, "setFixedLane");
     if (laneIndex == -1) {
         setLaneChangeMode(DEFAULT_NOTRACI_LC);
         return;
@@ -247,139 +366,203 @@ void CommandInterface::Vehicle::setFixedLane(int8_t laneIndex, bool safe)
 
 void CommandInterface::Vehicle::getRadarMeasurements(double& distance, double& relativeSpeed)
 {
-    std::string v;
-    veinsVehicle().getParameter(PAR_RADAR_DATA, v);
-    ParBuffer buf(v);
-    buf >> distance >> relativeSpeed;
+    ApiCall call(cifc, "getRadarMeasurements");
+    const VehicleState& state = cifc->getVehicleState(nodeId);
+    distance = state.radarDistance;
+    relativeSpeed = state.radarRelativeSpeed;
 }
 
 void CommandInterface::Vehicle::setLeaderVehicleFakeData(double controllerAcceleration, double acceleration, double speed)
 {
-    ParBuffer buf;
+    ApiCall call(cifc, "setLeaderVehicleFakeData");
+    ParameterBuffer& buf = cifc->parameterBuffer;
+    buf.clear();
     buf << speed << acceleration << controllerAcceleration;
-    veinsVehicle().setParameter(PAR_LEADER_FAKE_DATA, buf.str());
+    cifc->setCoalescedParameter(nodeId, PAR_LEADER_FAKE_DATA, -1, buf.str());
 }
 
 void CommandInterface::Vehicle::setLeaderFakeData(double leaderSpeed, double leaderAcceleration)
 {
+    ApiCall call(cifc, "setLeaderFakeData");
     std::cout << "setLeaderFakeData() is deprecated and will be removed. Please use setLeaderVehicleFakeData()\n";
     setLeaderVehicleFakeData(leaderAcceleration, leaderAcceleration, leaderSpeed);
 }
 
 void CommandInterface::Vehicle::setFrontVehicleFakeData(double controllerAcceleration, double acceleration, double speed, double distance)
 {
-    ParBuffer buf;
+    ApiCall call(cifc, "setFrontVehicleFakeData");
+    ParameterBuffer& buf = cifc->parameterBuffer;
+    buf.clear();
     buf << speed << acceleration << distance << controllerAcceleration;
-    veinsVehicle().setParameter(PAR_FRONT_FAKE_DATA, buf.str());
+    cifc->setCoalescedParameter(nodeId, PAR_FRONT_FAKE_DATA, -1, buf.str());
 }
 
 void CommandInterface::Vehicle::setPrecedingVehicleData(double speed, double acceleration, double positionX, double positionY, double time)
 {
+    ApiCall call(cifc, "setPrecedingVehicleData");
     std::cout << "setPrecedingVehicleData() is deprecated and will be removed. Please use setFrontVehicleData()\n";
     setFrontVehicleData(acceleration, acceleration, speed, positionX, positionY, time);
 }
 
 void CommandInterface::Vehicle::setFrontFakeData(double frontDistance, double frontSpeed, double frontAcceleration)
 {
+    ApiCall call(cifc, "setFrontFakeData");
     std::cout << "setFrontFakeData() is deprecated and will be removed. Please use setFrontVehicleFakeData()\n";
     setFrontVehicleFakeData(frontAcceleration, frontAcceleration, frontSpeed, frontDistance);
 }
 
 double CommandInterface::Vehicle::getDistanceToRouteEnd()
 {
+    ApiCall call(cifc, "getDistanceToRouteEnd");
     double v;
-    veinsVehicle().getParameter(PAR_DISTANCE_TO_END, v);
+    getParameter(PAR_DISTANCE_TO_END, v);
     return v;
 }
 
 double CommandInterface::Vehicle::getDistanceFromRouteBegin()
 {
+    ApiCall call(cifc, "getDistanceFromRouteBegin");
     double v;
-    veinsVehicle().getParameter(PAR_DISTANCE_FROM_BEGIN, v);
+    getParameter(PAR_DISTANCE_FROM_BEGIN, v);
     return v;
 }
 
 double CommandInterface::Vehicle::getACCAcceleration()
 {
+    ApiCall call(cifc, "getACCAcceleration");
     double v;
-    veinsVehicle().getParameter(PAR_ACC_ACCELERATION, v);
+    getParameter(PAR_ACC_ACCELERATION, v);
     return v;
 }
 
 void CommandInterface::Vehicle::setVehicleData(const struct VEHICLE_DATA* data)
 {
-    ParBuffer buf;
+    ApiCall call(cifc, "setVehicleData");
+    ParameterBuffer& buf = cifc->parameterBuffer;
+    buf.clear();
     buf << data->index << data->speed << data->acceleration << data->positionX << data->positionY << data->time << data->length << data->u << data->speedX << data->speedY << data->angle;
-    veinsVehicle().setParameter(CC_PAR_VEHICLE_DATA, buf.str());
+    cifc->setCoalescedParameter(nodeId, CC_PAR_VEHICLE_DATA, data->index, buf.str());
 }
 
 void CommandInterface::Vehicle::getStoredVehicleData(struct VEHICLE_DATA* data, int index)
 {
-    ParBuffer inBuf;
-    std::string v;
-    inBuf << CC_PAR_VEHICLE_DATA << index;
-    veinsVehicle().getParameter(inBuf.str(), v);
-    ParBuffer outBuf(v);
-    outBuf >> data->index >> data->speed >> data->acceleration >> data->positionX >> data->positionY >> data->time >> data->length >> data->u >> data->speedX >> data->speedY >> data->angle;
+    ApiCall call(cifc, "getStoredVehicleData");
+    ParameterBuffer& buf = cifc->parameterBuffer;
+    buf.clear();
+    buf << CC_PAR_VEHICLE_DATA << index;
+    buf.set(cifc->getParameter(nodeId, buf.str()));
+    buf >> data->index >> data->speed >> data->acceleration >> data->positionX >> data->positionY >> data->time >> data->length >> data->u >> data->speedX >> data->speedY >> data->angle;
 }
 
 void CommandInterface::Vehicle::useControllerAcceleration(bool use)
 {
-    veinsVehicle().setParameter(PAR_USE_CONTROLLER_ACCELERATION, use ? 1 : 0);
+    ApiCall call(cifc, "useControllerAcceleration");
+    setParameter(PAR_USE_CONTROLLER_ACCELERATION, use ? 1 : 0);
 }
 
 void CommandInterface::Vehicle::getEngineData(int& gear, double& rpm)
 {
-    ParBuffer inBuf;
-    std::string v;
-    inBuf << PAR_ENGINE_DATA;
-    veinsVehicle().getParameter(inBuf.str(), v);
-    ParBuffer outBuf(v);
-    outBuf >> gear >> rpm;
+    ApiCall call(cifc, "getEngineData");
+    ParameterBuffer& buf = cifc->parameterBuffer;
+    buf.set(cifc->getParameter(nodeId, PAR_ENGINE_DATA));
+    buf >> gear >> rpm;
 }
 
 void CommandInterface::Vehicle::enableAutoFeed(bool enable, std::string leaderId, std::string frontId)
 {
+    ApiCall call(cifc, "enableAutoFeed");
     if (enable && (leaderId.compare("") == 0 || frontId.compare("") == 0)) return;
-    ParBuffer inBuf;
+    ParameterBuffer& inBuf = cifc->parameterBuffer;
+    inBuf.clear();
     if (enable)
         inBuf << 1 << leaderId << frontId;
     else
         inBuf << 0;
-    veinsVehicle().setParameter(PAR_USE_AUTO_FEEDING, inBuf.str());
+    setParameter(PAR_USE_AUTO_FEEDING, inBuf.str());
 }
 
 void CommandInterface::Vehicle::usePrediction(bool enable)
 {
-    veinsVehicle().setParameter(PAR_USE_PREDICTION, enable ? 1 : 0);
+    ApiCall call(cifc, "usePrediction");
+    setParameter(PAR_USE_PREDICTION, enable ? 1 : 0);
 }
 
 void CommandInterface::Vehicle::addPlatoonMember(std::string memberId, int position)
 {
-    ParBuffer inBuf;
+    ApiCall call(cifc, "addPlatoonMember");
+    ParameterBuffer& inBuf = cifc->parameterBuffer;
+    inBuf.clear();
     inBuf << memberId << position;
-    veinsVehicle().setParameter(PAR_ADD_MEMBER, inBuf.str());
+    setParameter(PAR_ADD_MEMBER, inBuf.str());
 }
 
 void CommandInterface::Vehicle::removePlatoonMember(std::string memberId)
 {
-    veinsVehicle().setParameter(PAR_REMOVE_MEMBER, memberId);
+    ApiCall call(cifc, "removePlatoonMember");
+    setParameter(PAR_REMOVE_MEMBER, memberId);
 }
 
 void CommandInterface::Vehicle::enableAutoLaneChanging(bool enable)
 {
-    veinsVehicle().setParameter(PAR_ENABLE_AUTO_LANE_CHANGE, enable ? 1 : 0);
+    ApiCall call(cifc, "enableAutoLaneChanging");
+    setParameter(PAR_ENABLE_AUTO_LANE_CHANGE, enable ? 1 : 0);
 }
 
 unsigned int CommandInterface::Vehicle::getLanesCount()
 {
+    ApiCall call(cifc, "getLanesCount");
     int v;
-    veinsVehicle().getParameter(PAR_LANES_COUNT, v);
+    getParameter(PAR_LANES_COUNT, v);
     return (unsigned int) v;
 }
 
+void CommandInterface::Vehicle::setParameter(const std::string& parameter, int value)
+{
+    ApiCall call(cifc, "setParameter");
+    std::stringstream strValue;
+    strValue << value;
+    setParameter(parameter, strValue.str());
+}
+
+void CommandInterface::Vehicle::setParameter(const std::string& parameter, double value)
+{
+    ApiCall call(cifc, "setParameter");
+    std::stringstream strValue;
+    strValue << value;
+    setParameter(parameter, strValue.str());
+}
+
+void CommandInterface::Vehicle::setParameter(const std::string& parameter, const std::string& value)
+{
+    ApiCall call(cifc, "setParameter");
+    cifc->setParameter(nodeId, parameter, value);
+}
+
+void CommandInterface::Vehicle::getParameter(const std::string& parameter, int& value)
+{
+    ApiCall call(cifc, "getParameter");
+    ParameterBuffer& buf = cifc->parameterBuffer;
+    buf.set(cifc->getParameter(nodeId, parameter));
+    buf >> value;
+}
+
+void CommandInterface::Vehicle::getParameter(const std::string& parameter, double& value)
+{
+    ApiCall call(cifc, "getParameter");
+    ParameterBuffer& buf = cifc->parameterBuffer;
+    buf.set(cifc->getParameter(nodeId, parameter));
+    buf >> value;
+}
+
+void CommandInterface::Vehicle::getParameter(const std::string& parameter, std::string& value)
+{
+    ApiCall call(cifc, "getParameter");
+    value = cifc->getParameter(nodeId, parameter);
+}
+
 void CommandInterface::Vehicle::setLaneChangeAction(int action)
 {
+    ApiCall call(cifc, "setLaneChangeAction");
     std::cout << "setLaneChangeAction API is deprecated. Please remove it from your code\n";
     uint8_t variableId = VAR_LANECHANGE_MODE;
     uint8_t type = TYPE_INTEGER;
@@ -388,19 +571,52 @@ void CommandInterface::Vehicle::setLaneChangeAction(int action)
         traciAction = FIX_LC;
     else
         traciAction = DEFAULT_NOTRACI_LC;
-    TraCIBuffer buf = cifc->connection->query(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << type << traciAction);
-    ASSERT(buf.eof());
+    cifc->sendCommand(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << type << traciAction);
 }
 
 void CommandInterface::executePlexeTimestep()
 {
-    std::vector<PlexeLaneChanges::iterator> satisfied;
+    ApiCall call(this, "executePlexeTimestep");
+    std::vector<PlexeLaneChanges::iterator> active;
     for (auto i = laneChanges.begin(); i != laneChanges.end(); i++) {
         if (i->second.wait) {
             i->second.wait = false;
             continue;
         }
-        int current = vehicle(i->first).veinsVehicle().getLaneIndex();
+        active.push_back(i);
+    }
+    if (active.empty()) return;
+
+    // read the lane of all the vehicles with a single request. for unsafe
+    // lane changes the direction is not known yet, so read the lane change
+    // state on both sides
+    std::vector<std::pair<uint8_t, TraCIBuffer>> queries;
+    for (auto i : active) {
+        queries.push_back({CMD_GET_VEHICLE_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(VAR_LANE_INDEX) << i->first});
+        if (!i->second.safe) {
+            for (int direction : {-1, 1}) queries.push_back({CMD_GET_VEHICLE_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(CMD_CHANGELANE) << i->first << static_cast<uint8_t>(TYPE_INTEGER) << direction});
+        }
+    }
+    TraCIBuffer response = query(queries);
+
+    // queue the resulting commands and send them all together at the end
+    bool batching = batchCommands;
+    batchCommands = true;
+
+    std::vector<PlexeLaneChanges::iterator> satisfied;
+    for (auto i : active) {
+        checkStatus(response, CMD_GET_VEHICLE_VARIABLE);
+        int current = readLaneIndex(response);
+        // lane change state towards the right (0) and the left (1)
+        int states[2] = {0, 0};
+        if (!i->second.safe) {
+            for (int& state : states) {
+                int state2;
+                checkStatus(response, CMD_GET_VEHICLE_VARIABLE);
+                readLaneChangeState(response, state, state2);
+            }
+        }
+
         int nLanes = i->second.lane - current;
         int direction;
         if (nLanes > 0)
@@ -418,21 +634,23 @@ void CommandInterface::executePlexeTimestep()
                 vehicle(i->first).setLaneChangeMode(FIX_LC_AGGRESSIVE);
         }
         else {
-            __changeLane(i->first, current, direction, i->second.safe);
+            __changeLane(i->first, current, direction, i->second.safe, states[direction > 0 ? 1 : 0]);
         }
     }
+    ASSERT(response.eof());
     for (int i = 0; i < satisfied.size(); i++) laneChanges.erase(satisfied[i]);
+
+    batchCommands = batching;
+    if (!batchCommands) flushCommands();
 }
 
-void CommandInterface::__changeLane(std::string veh, int current, int direction, bool safe)
+void CommandInterface::__changeLane(std::string veh, int current, int direction, bool safe, int state)
 {
     if (safe) {
         vehicle(veh).setLaneChangeMode(FIX_LC);
         vehicle(veh).changeLane(current + direction, 0);
     }
     else {
-        int state, state2;
-        vehicle(veh).getLaneChangeState(direction, state, state2);
         if ((state & lca_overlapping) == 0) {
             vehicle(veh).setLaneChangeMode(FIX_LC_AGGRESSIVE);
             vehicle(veh).changeLane(current + direction, 0);
@@ -441,5 +659,215 @@ void CommandInterface::__changeLane(std::string veh, int current, int direction,
     }
 }
 
+int CommandInterface::readLaneIndex(TraCIBuffer& response)
+{
+    uint8_t cmdLength;
+    response >> cmdLength;
+    uint8_t responseId;
+    response >> responseId;
+    ASSERT(responseId == RESPONSE_GET_VEHICLE_VARIABLE);
+    uint8_t variable;
+    response >> variable;
+    ASSERT(variable == VAR_LANE_INDEX);
+    std::string id;
+    response >> id;
+    uint8_t type;
+    response >> type;
+    ASSERT(type == TYPE_INTEGER);
+    int laneIndex;
+    response >> laneIndex;
+    return laneIndex;
+}
+
+void CommandInterface::readLaneChangeState(TraCIBuffer& response, int& state1, int& state2)
+{
+    uint8_t cmdLength;
+    response >> cmdLength;
+    uint8_t responseId;
+    response >> responseId;
+    ASSERT(responseId == RESPONSE_GET_VEHICLE_VARIABLE);
+    uint8_t variable;
+    response >> variable;
+    ASSERT(variable == CMD_CHANGELANE);
+    std::string id;
+    response >> id;
+    uint8_t type;
+    response >> type;
+    ASSERT(type == TYPE_COMPOUND);
+    int count;
+    response >> count;
+    ASSERT(count == 2);
+    response >> type;
+    ASSERT(type == TYPE_INTEGER);
+    response >> state1;
+    response >> type;
+    ASSERT(type == TYPE_INTEGER);
+    response >> state2;
+}
+
+void CommandInterface::sendCommand(uint8_t commandId, const TraCIBuffer& buf)
+{
+    if (batchCommands) {
+        pendingCommands.push_back({commandId, veins::makeTraCICommand(commandId, buf)});
+    }
+    else {
+        roundTrips++;
+        TraCIBuffer response = connection->query(commandId, buf);
+        ASSERT(response.eof());
+    }
+}
+
+void CommandInterface::sendCommand(uint8_t commandId, const TraCIBuffer& buf, const CoalescingKey& key)
+{
+    if (!batchCommands) {
+        sendCommand(commandId, buf);
+        return;
+    }
+
+    auto pending = coalescedCommands.find(key);
+    if (pending == coalescedCommands.end()) {
+        coalescedCommands[key] = pendingCommands.size();
+        pendingCommands.push_back({commandId, veins::makeTraCICommand(commandId, buf)});
+    }
+    else {
+        // the previous value has not been sent yet: just overwrite it
+        pendingCommands[pending->second].command = veins::makeTraCICommand(commandId, buf);
+    }
+}
+
+TraCIBuffer CommandInterface::query(uint8_t commandId, const TraCIBuffer& buf)
+{
+    if (pendingCommands.empty()) {
+        roundTrips++;
+        return connection->query(commandId, buf);
+    }
+
+    // send the query together with the pending commands. SUMO answers in
+    // order, so the response to the query comes after the status of all
+    // the set commands
+    TraCIBuffer response = sendPendingCommands(veins::makeTraCICommand(commandId, buf));
+    checkStatus(response, commandId);
+    return response;
+}
+
+TraCIBuffer CommandInterface::query(const std::vector<std::pair<uint8_t, TraCIBuffer>>& commands)
+{
+    std::string queries;
+    for (const auto& command : commands) queries += veins::makeTraCICommand(command.first, command.second);
+    return sendPendingCommands(queries);
+}
+
+void CommandInterface::flushCommands()
+{
+    ApiCall call(this, "flushCommands");
+    if (pendingCommands.empty()) return;
+    TraCIBuffer response = sendPendingCommands();
+    ASSERT(response.eof());
+}
+
+TraCIBuffer CommandInterface::sendPendingCommands(const std::string& queries)
+{
+    std::string message;
+    for (const auto& pending : pendingCommands) message += pending.command;
+    message += queries;
+    roundTrips++;
+    connection->sendMessage(message);
+    TraCIBuffer response(connection->receiveMessage());
+    for (const auto& pending : pendingCommands) checkStatus(response, pending.commandId);
+    pendingCommands.clear();
+    coalescedCommands.clear();
+    return response;
+}
+
+void CommandInterface::checkStatus(TraCIBuffer& buf, uint8_t commandId)
+{
+    uint8_t cmdLength;
+    buf >> cmdLength;
+    if (cmdLength == 0) {
+        uint32_t cmdLengthExt;
+        buf >> cmdLengthExt;
+    }
+    uint8_t commandResp;
+    buf >> commandResp;
+    ASSERT(commandResp == commandId);
+    uint8_t result;
+    buf >> result;
+    std::string description;
+    buf >> description;
+    if (result == RTYPE_NOTIMPLEMENTED) throw cRuntimeError("TraCI server reported command 0x%2x not implemented (\"%s\"). Might need newer version.", commandId, description.c_str());
+    if (result == RTYPE_ERR) throw cRuntimeError("TraCI server reported error executing command 0x%2x (\"%s\").", commandId, description.c_str());
+    ASSERT(result == RTYPE_OK);
+}
+
+void CommandInterface::setParameter(const std::string& nodeId, const std::string& parameter, const std::string& value)
+{
+    static int32_t nParameters = 2;
+    sendCommand(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(VAR_PARAMETER) << nodeId << static_cast<uint8_t>(TYPE_COMPOUND) << nParameters << static_cast<uint8_t>(TYPE_STRING) << parameter << static_cast<uint8_t>(TYPE_STRING) << value);
+}
+
+void CommandInterface::setCoalescedParameter(const std::string& nodeId, const std::string& parameter, int index, const std::string& value)
+{
+    static int32_t nParameters = 2;
+    sendCommand(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(VAR_PARAMETER) << nodeId << static_cast<uint8_t>(TYPE_COMPOUND) << nParameters << static_cast<uint8_t>(TYPE_STRING) << parameter << static_cast<uint8_t>(TYPE_STRING) << value, CoalescingKey(nodeId, parameter, index));
+}
+
+std::string CommandInterface::getParameter(const std::string& nodeId, const std::string& parameter)
+{
+    TraCIBuffer response = query(CMD_GET_VEHICLE_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(VAR_PARAMETER) << nodeId << static_cast<uint8_t>(TYPE_STRING) << parameter);
+    return readParameter(response, nodeId);
+}
+
+std::string CommandInterface::readParameter(TraCIBuffer& response, const std::string& nodeId)
+{
+    uint8_t cmdLength;
+    response >> cmdLength;
+    if (cmdLength == 0) {
+        uint32_t cmdLengthExt;
+        response >> cmdLengthExt;
+    }
+    uint8_t responseId;
+    response >> responseId;
+    ASSERT(responseId == RESPONSE_GET_VEHICLE_VARIABLE);
+    uint8_t variable;
+    response >> variable;
+    ASSERT(variable == VAR_PARAMETER);
+    std::string id;
+    response >> id;
+    ASSERT(id == nodeId);
+    uint8_t type;
+    response >> type;
+    ASSERT(type == TYPE_STRING);
+    std::string value;
+    response >> value;
+    return value;
+}
+
+const CommandInterface::VehicleState& CommandInterface::getVehicleState(const std::string& nodeId)
+{
+    auto cached = vehicleStates.find(nodeId);
+    if (cached != vehicleStates.end()) return cached->second;
+
+    // fetch everything the vehicle measures with a single round trip
+    TraCIBuffer response = query({
+        {CMD_GET_VEHICLE_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(VAR_PARAMETER) << nodeId << static_cast<uint8_t>(TYPE_STRING) << PAR_SPEED_AND_ACCELERATION},
+        {CMD_GET_VEHICLE_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(VAR_PARAMETER) << nodeId << static_cast<uint8_t>(TYPE_STRING) << PAR_RADAR_DATA},
+    });
+
+    VehicleState& state = vehicleStates[nodeId];
+    checkStatus(response, CMD_GET_VEHICLE_VARIABLE);
+    parameterBuffer.set(readParameter(response, nodeId));
+    parameterBuffer >> state.data.speed >> state.data.acceleration >> state.data.u >> state.data.positionX >> state.data.positionY >> state.data.time >> state.data.speedX >> state.data.speedY >> state.data.angle;
+    checkStatus(response, CMD_GET_VEHICLE_VARIABLE);
+    parameterBuffer.set(readParameter(response, nodeId));
+    parameterBuffer >> state.radarDistance >> state.radarRelativeSpeed;
+    ASSERT(response.eof());
+    return state;
+}
+
+void CommandInterface::invalidateVehicleStates()
+{
+    vehicleStates.clear();
+}
+
 } // namespace traci
 } // namespace plexe
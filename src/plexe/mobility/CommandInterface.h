@@ -22,11 +22,17 @@
 
 #include "plexe/plexe.h"
 #include "plexe/CC_Const.h"
+#include "plexe/mobility/ParameterBuffer.h"
+#include "plexe/utilities/LogLinearHistogram.h"
 
 #include <veins/modules/utility/HasLogProxy.h>
 #include <veins/modules/mobility/traci/TraCICommandInterface.h>
+#include <veins/modules/mobility/traci/TraCIBuffer.h>
 
+#include <chrono>
 #include <map>
+#include <tuple>
+#include <vector>
 
 namespace veins {
 class TraCIConnection;
@@ -37,6 +43,16 @@ namespace traci {
 
 class CommandInterface : public veins::HasLogProxy {
 public:
+    /**
+     * Lane change state and gaps on a neighbouring lane
+     */
+    struct LaneGapInfo {
+        int state;
+        int state2;
+        double minBack;
+        double minFront;
+    };
+
     class Vehicle {
     public:
         Vehicle(CommandInterface* cifc, const std::string& nodeId)
@@ -51,6 +67,13 @@ public:
          */
         double getMinNeighDistance(uint8_t direction, uint8_t longitudinalDirection);
 
+        /**
+         * Returns the lane change state towards the given direction (1 for
+         * left, -1 for right) together with the minimum distance from the
+         * vehicles behind and ahead in that lane, with a single request
+         */
+        LaneGapInfo getLaneGapInfo(int direction);
+
         void setLaneChangeMode(int mode);
         void getLaneChangeState(int direction, int& state1, int& state2);
         void changeLane(int lane, double duration);
@@ -285,6 +308,23 @@ public:
             return {cifc->veinsCommandInterface, nodeId};
         }
 
+        /**
+         * Sets a generic parameter of the vehicle. Differently from the
+         * veins API, this goes through the Plexe command pipeline, so it is
+         * queued when batching is enabled
+         */
+        void setParameter(const std::string& parameter, int value);
+        void setParameter(const std::string& parameter, double value);
+        void setParameter(const std::string& parameter, const std::string& value);
+
+        /**
+         * Gets a generic parameter of the vehicle. Pending commands are sent
+         * together with the query, so the result always reflects them
+         */
+        void getParameter(const std::string& parameter, int& value);
+        void getParameter(const std::string& parameter, double& value);
+        void getParameter(const std::string& parameter, std::string& value);
+
     protected:
         /**
          * Tells to the CC mobility model the desired lane change action to be performed
@@ -305,10 +345,50 @@ public:
         const std::string nodeId;
     };
 
-    CommandInterface(cComponent* owner, veins::TraCICommandInterface* commandInterface, veins::TraCIConnection* connection);
+    CommandInterface(cComponent* owner, veins::TraCICommandInterface* commandInterface, veins::TraCIConnection* connection, bool batchCommands = false);
 
     void executePlexeTimestep();
 
+    /**
+     * Sends all queued set commands to SUMO in a single TraCI message and
+     * checks their status responses. Does nothing if no command is pending
+     */
+    void flushCommands();
+
+    /**
+     * Returns whether set commands are queued and sent in batches instead
+     * of being sent one by one
+     */
+    bool isBatching() const
+    {
+        return batchCommands;
+    }
+
+    /**
+     * Enables the collection of call counts, round trips, and latencies
+     * for each API method, split by the class of the calling module
+     */
+    void setCollectStatistics(bool collect)
+    {
+        collectStatistics = collect;
+    }
+
+    /**
+     * Records the collected statistics as scalars of the given component
+     */
+    void recordStatistics(cComponent* component);
+
+    /**
+     * Prints a summary of the statistics collected so far
+     */
+    void logStatistics();
+
+    /**
+     * Drops the vehicle states read during the current timestep. Must be
+     * called whenever SUMO advances, so that the next read fetches fresh data
+     */
+    void invalidateVehicleStates();
+
     Vehicle vehicle(const std::string& nodeId)
     {
         return {this, nodeId};
@@ -322,13 +402,158 @@ private:
     };
     using PlexeLaneChanges = std::map<std::string, PlexeLaneChange>;
 
+    /**
+     * Data measured by a vehicle, which only changes when SUMO advances.
+     * It is fetched once per timestep and shared by all the readers
+     */
+    struct VehicleState {
+        plexe::VEHICLE_DATA data;
+        double radarDistance;
+        double radarRelativeSpeed;
+    };
+    using VehicleStates = std::map<std::string, VehicleState>;
+
+    struct PendingCommand {
+        uint8_t commandId;
+        // the whole command, already in TraCI format
+        std::string command;
+    };
+    // vehicle, parameter and index (-1 if not used) of a coalesced write
+    using CoalescingKey = std::tuple<std::string, std::string, int>;
+
+    // plain counters and histograms rather than statistic objects: calls
+    // are accounted in the context of the calling module, which must not
+    // become their owner
+    struct ApiStatistics {
+        ApiStatistics();
+        long calls;
+        long roundTrips;
+        plexe::LogLinearHistogram latency;
+    };
+    // API method and class of the calling module
+    using ApiStatisticsKey = std::pair<std::string, std::string>;
+
+    /**
+     * Accounts a call to an API method, from construction to destruction.
+     * Calls made by other API methods are not accounted separately
+     */
+    class ApiCall {
+    public:
+        ApiCall(CommandInterface* cifc, const char* api);
+        ~ApiCall();
+
+    private:
+        CommandInterface* cifc;
+        const char* api;
+        bool outermost;
+        long startRoundTrips;
+        std::chrono::steady_clock::time_point start;
+    };
+
     static const unsigned lca_overlapping = 1 << 13;
 
-    void __changeLane(std::string veh, int current, int direction, bool safe = true);
+    /**
+     * Moves a vehicle towards its target lane. For unsafe lane changes,
+     * state is the lane change state of the vehicle in the given direction
+     */
+    void __changeLane(std::string veh, int current, int direction, bool safe, int state);
+
+    /**
+     * Parse the responses to lane index and lane change state queries
+     */
+    int readLaneIndex(veins::TraCIBuffer& response);
+    void readLaneChangeState(veins::TraCIBuffer& response, int& state1, int& state2);
+    double readMinNeighDistance(veins::TraCIBuffer& response);
+
+    /**
+     * Builds the query for the neighbours of a vehicle. See
+     * Vehicle::getMinNeighDistance for the meaning of the directions
+     */
+    static veins::TraCIBuffer neighboursQuery(const std::string& nodeId, uint8_t direction, uint8_t longitudinalDirection);
+
+    /**
+     * Appends the queries needed by getLaneGapInfo, and reads their
+     * responses, which must be preceded by their status
+     */
+    static void laneGapQueries(std::vector<std::pair<uint8_t, veins::TraCIBuffer>>& queries, const std::string& nodeId, int direction);
+    LaneGapInfo readLaneGapInfo(veins::TraCIBuffer& response);
+
+    /**
+     * Sends a command which is only expected to return a status response.
+     * If batching is enabled, the command is queued until the next flush
+     */
+    void sendCommand(uint8_t commandId, const veins::TraCIBuffer& buf);
+
+    /**
+     * Same as above, but if a command with the same key is still queued it
+     * is replaced, so only the latest value is sent to SUMO
+     */
+    void sendCommand(uint8_t commandId, const veins::TraCIBuffer& buf, const CoalescingKey& key);
+
+    /**
+     * Sends a command expecting a response, such as a get command. Pending
+     * set commands are sent in the same TraCI message, before the query
+     */
+    veins::TraCIBuffer query(uint8_t commandId, const veins::TraCIBuffer& buf);
+
+    /**
+     * Sends several commands expecting a response in a single TraCI message,
+     * after the pending set commands. The returned buffer contains, for each
+     * command in order, its status followed by its response
+     */
+    veins::TraCIBuffer query(const std::vector<std::pair<uint8_t, veins::TraCIBuffer>>& commands);
+
+    /**
+     * Sends all pending commands in a single message, followed by the given
+     * queries, and checks the status responses of the pending commands.
+     * Returns the rest of the response, if any
+     */
+    veins::TraCIBuffer sendPendingCommands(const std::string& queries = "");
+
+    /**
+     * Reads the status response of a command, throwing an error if SUMO
+     * could not execute it
+     */
+    void checkStatus(veins::TraCIBuffer& buf, uint8_t commandId);
+
+    void setParameter(const std::string& nodeId, const std::string& parameter, const std::string& value);
+    std::string getParameter(const std::string& nodeId, const std::string& parameter);
+
+    /**
+     * Sets a parameter that is periodically overwritten, such as the data
+     * received by beacons. When batching, writes to the same parameter and
+     * index of a vehicle within a timestep are merged into one
+     */
+    void setCoalescedParameter(const std::string& nodeId, const std::string& parameter, int index, const std::string& value);
+    std::string readParameter(veins::TraCIBuffer& response, const std::string& nodeId);
+
+    /**
+     * Returns the state of a vehicle in the current timestep, fetching it
+     * from SUMO if no one has read it yet
+     */
+    const VehicleState& getVehicleState(const std::string& nodeId);
 
     veins::TraCICommandInterface* veinsCommandInterface;
     veins::TraCIConnection* connection;
     PlexeLaneChanges laneChanges;
+
+    // queue set commands and send them in a single message
+    bool batchCommands;
+    // set commands waiting to be sent
+    std::vector<PendingCommand> pendingCommands;
+    // position in pendingCommands of the writes that can be coalesced
+    std::map<CoalescingKey, size_t> coalescedCommands;
+    // reused to encode and decode parameter values without allocating
+    ParameterBuffer parameterBuffer;
+    // statistics about the usage of the API
+    bool collectStatistics;
+    // number of messages exchanged with SUMO
+    long roundTrips;
+    // number of nested API calls currently being executed
+    int callDepth;
+    std::map<ApiStatisticsKey, ApiStatistics> apiStatistics;
+    // vehicle states already read in the current timestep
+    VehicleStates vehicleStates;
 };
 
 } // namespace traci
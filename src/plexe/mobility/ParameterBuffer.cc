@@ -0,0 +1,150 @@
+//
+// Copyright (C) 2018-2021 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "ParameterBuffer.h"
+
+#if __cplusplus >= 201703L
+#include <charconv>
+#endif
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace plexe {
+namespace traci {
+
+namespace {
+// enough for any double printed with six significant digits
+const size_t maxNumberLength = 32;
+
+#ifdef __cpp_lib_to_chars
+// from_chars accepts neither leading whitespace nor a plus sign, while the
+// sscanf used by veins::ParBuffer accepts both
+const char* skipBlanksAndPlus(const char* begin, const char* end)
+{
+    while (begin != end && isspace((unsigned char) *begin)) begin++;
+    if (begin != end && *begin == '+' && (begin + 1 == end || (begin[1] != '+' && begin[1] != '-'))) begin++;
+    return begin;
+}
+#endif
+} // namespace
+
+ParameterBuffer& ParameterBuffer::operator<<(double value)
+{
+    appendSeparator();
+    char number[maxNumberLength];
+#ifdef __cpp_lib_to_chars
+    // same output as printf's %.6g, which is what iostreams use by default
+    auto result = std::to_chars(number, number + maxNumberLength, value, std::chars_format::general, 6);
+    outBuffer.append(number, result.ptr);
+#else
+    int length = snprintf(number, maxNumberLength, "%.6g", value);
+    outBuffer.append(number, length);
+#endif
+    return *this;
+}
+
+ParameterBuffer& ParameterBuffer::operator<<(int value)
+{
+    appendSeparator();
+    char number[maxNumberLength];
+#ifdef __cpp_lib_to_chars
+    auto result = std::to_chars(number, number + maxNumberLength, value);
+    outBuffer.append(number, result.ptr);
+#else
+    int length = snprintf(number, maxNumberLength, "%d", value);
+    outBuffer.append(number, length);
+#endif
+    return *this;
+}
+
+ParameterBuffer& ParameterBuffer::operator<<(const std::string& value)
+{
+    appendSeparator();
+    outBuffer += value;
+    return *this;
+}
+
+ParameterBuffer& ParameterBuffer::operator<<(const char* value)
+{
+    appendSeparator();
+    outBuffer += value;
+    return *this;
+}
+
+ParameterBuffer& ParameterBuffer::operator>>(double& value)
+{
+    const char* begin;
+    const char* end;
+    nextField(begin, end);
+    if (begin == end) return *this;
+#ifdef __cpp_lib_to_chars
+    std::from_chars(skipBlanksAndPlus(begin, end), end, value);
+#else
+    // the input string is null terminated and strtod stops at the separator
+    char* parsed;
+    double v = strtod(begin, &parsed);
+    if (parsed != begin) value = v;
+#endif
+    return *this;
+}
+
+ParameterBuffer& ParameterBuffer::operator>>(int& value)
+{
+    const char* begin;
+    const char* end;
+    nextField(begin, end);
+    if (begin == end) return *this;
+#ifdef __cpp_lib_to_chars
+    std::from_chars(skipBlanksAndPlus(begin, end), end, value);
+#else
+    char* parsed;
+    long v = strtol(begin, &parsed, 10);
+    if (parsed != begin) value = (int) v;
+#endif
+    return *this;
+}
+
+ParameterBuffer& ParameterBuffer::operator>>(std::string& value)
+{
+    const char* begin;
+    const char* end;
+    nextField(begin, end);
+    value.assign(begin, end);
+    return *this;
+}
+
+void ParameterBuffer::nextField(const char*& begin, const char*& end)
+{
+    begin = inBuffer.data() + inIndex;
+    if (eof()) {
+        end = begin;
+        return;
+    }
+    const char* last = inBuffer.data() + inBuffer.size();
+    const char* sep = static_cast<const char*>(memchr(begin, separator, last - begin));
+    end = sep ? sep : last;
+    inIndex = end - inBuffer.data() + (sep ? 1 : 0);
+}
+
+} // namespace traci
+} // namespace plexe
@@ -0,0 +1,107 @@
+//
+// Copyright (C) 2018-2021 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#pragma once
+
+#include <string>
+
+namespace plexe {
+namespace traci {
+
+/**
+ * Encoder/decoder for the colon separated values used by Plexe parameters.
+ * It produces exactly the same strings as veins::ParBuffer (doubles are
+ * printed with six significant digits, like an iostream does by default),
+ * but it does not go through iostreams. Storage is kept across clear() and
+ * set() calls, so a buffer that is reused does not allocate once it has
+ * grown to the size of the longest parameter
+ */
+class ParameterBuffer {
+public:
+    ParameterBuffer(char separator = ':')
+        : separator(separator)
+        , inIndex(0)
+    {
+    }
+
+    ParameterBuffer& operator<<(double value);
+    ParameterBuffer& operator<<(int value);
+    ParameterBuffer& operator<<(const std::string& value);
+    ParameterBuffer& operator<<(const char* value);
+
+    /**
+     * Read the next value. As for veins::ParBuffer, the value is left
+     * untouched if the field is empty or cannot be parsed
+     */
+    ParameterBuffer& operator>>(double& value);
+    ParameterBuffer& operator>>(int& value);
+    ParameterBuffer& operator>>(std::string& value);
+
+    /**
+     * Returns the encoded values
+     */
+    const std::string& str() const
+    {
+        return outBuffer;
+    }
+
+    /**
+     * Sets the string to decode values from
+     */
+    void set(const std::string& buf)
+    {
+        inBuffer = buf;
+        inIndex = 0;
+    }
+
+    /**
+     * Empties both the encoded and the decoded values, keeping the storage
+     */
+    void clear()
+    {
+        outBuffer.clear();
+        inBuffer.clear();
+        inIndex = 0;
+    }
+
+    bool eof() const
+    {
+        return inIndex >= inBuffer.size();
+    }
+
+private:
+    void appendSeparator()
+    {
+        if (!outBuffer.empty()) outBuffer += separator;
+    }
+
+    /**
+     * Returns the boundaries of the next field to decode and moves past it
+     */
+    void nextField(const char*& begin, const char*& end);
+
+    char separator;
+    std::string outBuffer;
+    std::string inBuffer;
+    size_t inIndex;
+};
+
+} // namespace traci
+} // namespace plexe
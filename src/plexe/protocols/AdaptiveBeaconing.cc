@@ -0,0 +1,209 @@
+//
+// Copyright (C) 2021 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+
+#include "AdaptiveBeaconing.h"
+
+#include "veins/modules/messages/PhyControlMessage_m.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace plexe {
+
+Define_Module(AdaptiveBeaconing)
+
+void AdaptiveBeaconing::initialize(int stage)
+{
+    BaseProtocol::initialize(stage);
+
+    if (stage == 0) {
+        std::string mode = par("dccMode").stdstringValue();
+        if (mode == "reactive")
+            dccMode = DccMode::REACTIVE;
+        else if (mode == "adaptive")
+            dccMode = DccMode::ADAPTIVE;
+        else
+            throw cRuntimeError("AdaptiveBeaconing: invalid dccMode \"%s\"", mode.c_str());
+
+        measurementInterval = SimTime(par("measurementInterval").doubleValue());
+        ASSERT2(measurementInterval > 0, "measurementInterval must be positive");
+
+        std::istringstream thresholds(par("reactiveThresholds").stdstringValue());
+        double threshold;
+        while (thresholds >> threshold) {
+            if (!reactiveThresholds.empty() && threshold <= reactiveThresholds.back()) throw cRuntimeError("AdaptiveBeaconing: reactiveThresholds must be in increasing order");
+            reactiveThresholds.push_back(threshold);
+        }
+        if (dccMode == DccMode::REACTIVE && reactiveThresholds.empty()) throw cRuntimeError("AdaptiveBeaconing: reactiveThresholds cannot be empty");
+
+        targetBusyRatio = par("targetBusyRatio");
+        alpha = par("alpha");
+        beta = par("beta");
+        maxStepUp = par("maxStepUp");
+        maxStepDown = par("maxStepDown");
+
+        leaderMinInterval = SimTime(par("leaderMinInterval").doubleValue());
+        leaderMaxInterval = SimTime(par("leaderMaxInterval").doubleValue());
+        followerMinInterval = SimTime(par("followerMinInterval").doubleValue());
+        followerMaxInterval = SimTime(par("followerMaxInterval").doubleValue());
+        tailMinInterval = SimTime(par("tailMinInterval").doubleValue());
+        tailMaxInterval = SimTime(par("tailMaxInterval").doubleValue());
+        ASSERT2(leaderMinInterval > 0 && leaderMinInterval <= leaderMaxInterval, "invalid beacon interval limits for the leader");
+        ASSERT2(followerMinInterval > 0 && followerMinInterval <= followerMaxInterval, "invalid beacon interval limits for the followers");
+        ASSERT2(tailMinInterval > 0 && tailMinInterval <= tailMaxInterval, "invalid beacon interval limits for the last vehicle");
+
+        adaptTxPower = par("adaptTxPower");
+        minTxPower = par("minTxPower");
+        maxTxPower = par("maxTxPower");
+        ASSERT2(minTxPower > 0 && minTxPower <= maxTxPower, "invalid transmit power limits");
+
+        lastTotalBusyTime = SimTime(0);
+        lastBusyRatio = 0;
+        txPower = maxTxPower;
+
+        busyRatioOut.setName("busyRatio");
+        beaconIntervalOut.setName("beaconInterval");
+        txPowerOut.setName("txPower");
+
+        updateDcc = new cMessage("updateDcc");
+    }
+
+    if (stage == 1) {
+        // start from the configured beaconing interval, within the limits
+        // of our role
+        SimTime minInterval, maxInterval;
+        getIntervalLimits(minInterval, maxInterval);
+        currentInterval = std::min(std::max(beaconingInterval, minInterval), maxInterval);
+        if (minInterval == maxInterval)
+            rateFraction = 1;
+        else
+            rateFraction = (1 / currentInterval.dbl() - 1 / maxInterval.dbl()) / (1 / minInterval.dbl() - 1 / maxInterval.dbl());
+
+        // random start time
+        SimTime beginTime = SimTime(uniform(0.001, currentInterval.dbl()));
+        lastBeacon = simTime() + beginTime;
+        scheduleAt(simTime() + currentInterval + beginTime, sendBeacon);
+        scheduleAt(simTime() + measurementInterval, updateDcc);
+    }
+}
+
+void AdaptiveBeaconing::handleSelfMsg(cMessage* msg)
+{
+
+    BaseProtocol::handleSelfMsg(msg);
+
+    if (msg == sendBeacon) {
+        sendPlatooningMessage(-1);
+        lastBeacon = simTime();
+        scheduleAt(simTime() + currentInterval, sendBeacon);
+    }
+    if (msg == updateDcc) {
+        updateBeaconing();
+        scheduleAt(simTime() + measurementInterval, updateDcc);
+    }
+}
+
+std::unique_ptr<BaseFrame1609_4> AdaptiveBeaconing::createBeacon(int destinationAddress, const VEHICLE_DATA& data)
+{
+    std::unique_ptr<BaseFrame1609_4> frame = BaseProtocol::createBeacon(destinationAddress, data);
+    if (adaptTxPower) {
+        veins::PhyControlMessage* ctrl = new veins::PhyControlMessage();
+        ctrl->setTxPower_mW(txPower);
+        frame->setControlInfo(ctrl);
+    }
+    return frame;
+}
+
+void AdaptiveBeaconing::getIntervalLimits(SimTime& minInterval, SimTime& maxInterval) const
+{
+    if (positionHelper->isLast()) {
+        // nobody uses our beacons for its CACC. this includes vehicles
+        // that are not part of a platoon
+        minInterval = tailMinInterval;
+        maxInterval = tailMaxInterval;
+    }
+    else if (positionHelper->isLeader()) {
+        minInterval = leaderMinInterval;
+        maxInterval = leaderMaxInterval;
+    }
+    else {
+        minInterval = followerMinInterval;
+        maxInterval = followerMaxInterval;
+    }
+}
+
+void AdaptiveBeaconing::updateBeaconing()
+{
+    // the busy time accounted by BaseProtocol includes the ongoing busy
+    // period, if any, so it is split between this interval and the next one
+    SimTime totalBusyTime = getTotalBusyTime();
+    double busyRatio = std::min((totalBusyTime - lastTotalBusyTime) / measurementInterval, 1.0);
+    lastTotalBusyTime = totalBusyTime;
+
+    if (dccMode == DccMode::REACTIVE) {
+        // the state is the number of thresholds exceeded. the first state
+        // uses the maximum rate, the last one the minimum rate
+        size_t state = std::upper_bound(reactiveThresholds.begin(), reactiveThresholds.end(), busyRatio) - reactiveThresholds.begin();
+        rateFraction = 1 - (double) state / reactiveThresholds.size();
+    }
+    else {
+        // LIMERIC, as in ETSI TS 102 687, with the rate normalized to the
+        // limits of our role. the busy ratio is averaged with the previous
+        // measurement to smooth the input of the loop
+        double smoothedBusyRatio = (busyRatio + lastBusyRatio) / 2;
+        double offset = beta * (targetBusyRatio - smoothedBusyRatio);
+        offset = std::min(std::max(offset, -maxStepDown), maxStepUp);
+        rateFraction = std::min(std::max((1 - alpha) * rateFraction + offset, 0.0), 1.0);
+    }
+    lastBusyRatio = busyRatio;
+
+    // the role might have changed, e.g., after a maneuver, so limits are
+    // computed every time
+    SimTime minInterval, maxInterval;
+    getIntervalLimits(minInterval, maxInterval);
+    double minRate = 1 / maxInterval.dbl();
+    double maxRate = 1 / minInterval.dbl();
+    currentInterval = SimTime(1 / (minRate + rateFraction * (maxRate - minRate)));
+    if (adaptTxPower) txPower = minTxPower + rateFraction * (maxTxPower - minTxPower);
+
+    // do not wait for a beacon scheduled with a longer interval
+    if (sendBeacon->isScheduled() && sendBeacon->getArrivalTime() > lastBeacon + currentInterval) {
+        cancelEvent(sendBeacon);
+        scheduleAt(std::max(simTime(), lastBeacon + currentInterval), sendBeacon);
+    }
+
+    busyRatioOut.record(busyRatio);
+    beaconIntervalOut.record(currentInterval);
+    txPowerOut.record(txPower);
+}
+
+AdaptiveBeaconing::AdaptiveBeaconing()
+{
+    updateDcc = nullptr;
+}
+
+AdaptiveBeaconing::~AdaptiveBeaconing()
+{
+    cancelAndDelete(updateDcc);
+    updateDcc = nullptr;
+}
+
+} // namespace plexe
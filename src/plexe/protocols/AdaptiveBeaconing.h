@@ -0,0 +1,110 @@
+//
+// Copyright (C) 2021 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+
+#ifndef ADAPTIVEBEACONING_H_
+#define ADAPTIVEBEACONING_H_
+
+#include "BaseProtocol.h"
+
+namespace plexe {
+
+/**
+ * Beaconing protocol adapting the beacon interval, and optionally the
+ * transmit power, to the measured channel busy ratio, in the style of the
+ * decentralized congestion control (DCC) of ETSI TS 102 687. The "reactive"
+ * mode maps the busy ratio to a set of states through fixed thresholds,
+ * while the "adaptive" mode uses the LIMERIC linear control loop to
+ * converge towards a target busy ratio.
+ *
+ * The beacon interval is always kept within the limits configured for the
+ * role of the vehicle, so that the leader and the members with a vehicle
+ * behind can be forced to beacon often enough for the CACC of their
+ * followers independently of the channel load. Only the last member of a
+ * platoon and vehicles driving alone can use the relaxed tail limits
+ */
+class AdaptiveBeaconing : public BaseProtocol {
+public:
+    enum class DccMode {
+        REACTIVE,
+        ADAPTIVE
+    };
+
+protected:
+    virtual void handleSelfMsg(cMessage* msg) override;
+    using BaseProtocol::createBeacon;
+    virtual std::unique_ptr<BaseFrame1609_4> createBeacon(int destinationAddress, const VEHICLE_DATA& data) override;
+
+    /**
+     * Computes the busy ratio of the last measurement interval and
+     * updates beacon interval and transmit power accordingly
+     */
+    virtual void updateBeaconing();
+
+    // returns the interval limits for the current role of the vehicle
+    void getIntervalLimits(SimTime& minInterval, SimTime& maxInterval) const;
+
+    DccMode dccMode;
+    // period over which the busy ratio is measured
+    SimTime measurementInterval;
+    // busy ratio thresholds between the states of the reactive mode
+    std::vector<double> reactiveThresholds;
+    // parameters of the adaptive mode
+    double targetBusyRatio;
+    double alpha;
+    double beta;
+    double maxStepUp;
+    double maxStepDown;
+    // beacon interval limits for leaders, followers with a vehicle behind,
+    // and vehicles nobody follows
+    SimTime leaderMinInterval, leaderMaxInterval;
+    SimTime followerMinInterval, followerMaxInterval;
+    SimTime tailMinInterval, tailMaxInterval;
+    // transmit power control
+    bool adaptTxPower;
+    double minTxPower, maxTxPower;
+
+    // total channel busy time at the end of the previous measurement interval
+    SimTime lastTotalBusyTime;
+    // busy ratio of the previous measurement interval
+    double lastBusyRatio;
+    // fraction of the maximum beacon rate currently in use, in [0, 1]
+    double rateFraction;
+    // current beacon interval and transmit power
+    SimTime currentInterval;
+    double txPower;
+    // time at which the last beacon was sent
+    SimTime lastBeacon;
+
+    cMessage* updateDcc;
+
+    // output vectors for the busy ratio and the control output
+    cOutVector busyRatioOut, beaconIntervalOut, txPowerOut;
+
+public:
+    AdaptiveBeaconing();
+    virtual ~AdaptiveBeaconing();
+
+    virtual void initialize(int stage) override;
+};
+
+} // namespace plexe
+
+#endif /* ADAPTIVEBEACONING_H_ */
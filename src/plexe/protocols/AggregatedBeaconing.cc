@@ -0,0 +1,145 @@
+//
+// Copyright (C) 2021 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+
+#include "AggregatedBeaconing.h"
+
+using namespace veins;
+
+namespace plexe {
+
+Define_Module(AggregatedBeaconing)
+
+void AggregatedBeaconing::initialize(int stage)
+{
+    BaseProtocol::initialize(stage);
+
+    if (stage == 0) {
+        relayPosition = par("relayPosition");
+        memberBeaconingInterval = SimTime(par("memberBeaconingInterval").doubleValue());
+        unicastToAggregator = par("unicastToAggregator");
+        maxStateAge = SimTime(par("maxStateAge").doubleValue());
+        aggregatedHeaderSize = par("aggregatedHeaderSize");
+        memberStateSize = par("memberStateSize");
+        aggregatedSeq_n = 0;
+
+        // random start time
+        SimTime beginTime = SimTime(uniform(0.001, beaconingInterval));
+        if (beaconingInterval > 0) scheduleAt(simTime() + beaconingInterval + beginTime, sendBeacon);
+    }
+}
+
+void AggregatedBeaconing::handleSelfMsg(cMessage* msg)
+{
+
+    BaseProtocol::handleSelfMsg(msg);
+
+    if (msg == sendBeacon) {
+        // the role is checked every time, as it might change with maneuvers
+        if (isAggregator()) {
+            sendAggregatedBeacon();
+            scheduleAt(simTime() + beaconingInterval, sendBeacon);
+        }
+        else {
+            sendPlatooningMessage(unicastToAggregator ? getAggregatorId() : -1);
+            scheduleAt(simTime() + memberBeaconingInterval, sendBeacon);
+        }
+    }
+}
+
+int AggregatedBeaconing::getAggregatorId() const
+{
+    const std::vector<int>& formation = positionHelper->getPlatoonFormation();
+    if (relayPosition < (int) formation.size()) return formation[relayPosition];
+    return positionHelper->getLeaderId();
+}
+
+bool AggregatedBeaconing::isAggregator() const
+{
+    return getAggregatorId() == myId;
+}
+
+void AggregatedBeaconing::sendAggregatedBeacon()
+{
+    // our own state. not taken from createBeacon(), which would advance the
+    // sequence number and the compact encoding state of our own beacons
+    VEHICLE_DATA data;
+    plexeTraciVehicle->getVehicleData(&data);
+
+    const std::vector<int>& formation = positionHelper->getPlatoonFormation();
+    AggregatedBeacon* pkt = new AggregatedBeacon();
+    pkt->setVehicleId(myId);
+    pkt->setPlatoonId(positionHelper->getPlatoonId());
+    pkt->setSequenceNumber(aggregatedSeq_n++);
+    pkt->setKind(AGGREGATED_BEACON_TYPE);
+    pkt->setMembersArraySize(formation.size());
+
+    size_t n = 0;
+    for (int vehicleId : formation) {
+        MemberState member;
+        member.vehicleId = vehicleId;
+        if (vehicleId == myId) {
+            member.controllerAcceleration = data.u;
+            member.acceleration = data.acceleration;
+            member.speed = data.speed;
+            member.positionX = data.positionX;
+            member.positionY = data.positionY;
+            member.time = data.time;
+            member.length = length;
+            member.speedX = data.speedX;
+            member.speedY = data.speedY;
+            member.angle = data.angle;
+        }
+        else {
+            const NeighborState* neighbor = getNeighborState(vehicleId);
+            if (!neighbor || simTime() - neighbor->lastReception > maxStateAge) continue;
+            member.controllerAcceleration = neighbor->data.u;
+            member.acceleration = neighbor->data.acceleration;
+            member.speed = neighbor->data.speed;
+            member.positionX = neighbor->data.positionX;
+            member.positionY = neighbor->data.positionY;
+            member.time = neighbor->data.time;
+            member.length = neighbor->data.length;
+            member.speedX = neighbor->data.speedX;
+            member.speedY = neighbor->data.speedY;
+            member.angle = neighbor->data.angle;
+        }
+        pkt->setMembers(n++, member);
+    }
+    pkt->setMembersArraySize(n);
+    pkt->setByteLength(aggregatedHeaderSize + n * memberStateSize);
+
+    BaseFrame1609_4* frame = new BaseFrame1609_4("", AGGREGATED_BEACON_TYPE);
+    frame->setRecipientAddress(LAddress::L2BROADCAST());
+    frame->setChannelNumber(static_cast<int>(Channel::cch));
+    frame->setUserPriority(priority);
+    frame->encapsulate(pkt);
+    sendTo(frame, PlexeRadioInterfaces::ALL);
+}
+
+AggregatedBeaconing::AggregatedBeaconing()
+{
+}
+
+AggregatedBeaconing::~AggregatedBeaconing()
+{
+}
+
+} // namespace plexe
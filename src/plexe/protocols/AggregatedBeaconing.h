@@ -0,0 +1,81 @@
+//
+// Copyright (C) 2021 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+
+#ifndef AGGREGATEDBEACONING_H_
+#define AGGREGATEDBEACONING_H_
+
+#include "BaseProtocol.h"
+
+#include "plexe/messages/AggregatedBeacon_m.h"
+
+namespace plexe {
+
+/**
+ * Beaconing protocol where a single vehicle of the platoon (the leader by
+ * default, or a relay) periodically broadcasts one AggregatedBeacon with
+ * the state of all members. The other members report their own state to it
+ * less often, with broadcast beacons by default or optionally with unicast
+ * ones, so they do not have to process the beacons of all the other members.
+ *
+ * The aggregator knows about the other members only through their reports,
+ * so the state of a member reaches the others with up to one more
+ * beaconing interval of delay
+ */
+class AggregatedBeaconing : public BaseProtocol {
+protected:
+    virtual void handleSelfMsg(cMessage* msg) override;
+
+    // returns whether this vehicle sends aggregated beacons for its platoon
+    bool isAggregator() const;
+    // returns the id of the vehicle sending aggregated beacons for our platoon
+    int getAggregatorId() const;
+
+    /**
+     * Sends an aggregated beacon with our state and the latest state
+     * received from the other members of the platoon
+     */
+    virtual void sendAggregatedBeacon();
+
+    // position in the platoon of the vehicle sending aggregated beacons
+    int relayPosition;
+    // interval of the beacons members send to the aggregator
+    SimTime memberBeaconingInterval;
+    // whether members send their beacons to the aggregator only
+    bool unicastToAggregator;
+    // members whose last report is older than this are not included
+    SimTime maxStateAge;
+    // size of the header of an aggregated beacon and of each member state
+    int aggregatedHeaderSize;
+    int memberStateSize;
+
+    // sequence number of aggregated beacons
+    int aggregatedSeq_n;
+
+public:
+    AggregatedBeaconing();
+    virtual ~AggregatedBeaconing();
+
+    virtual void initialize(int stage) override;
+};
+
+} // namespace plexe
+
+#endif /* AGGREGATEDBEACONING_H_ */
@@ -28,6 +28,8 @@
 #include "plexe/driver/Veins11pRadioDriver.h"
 #include "plexe/messages/PlexeInterfaceControlInfo_m.h"
 
+#include <cmath>
+
 using namespace veins;
 
 namespace plexe {
@@ -35,6 +37,7 @@ namespace plexe {
 Define_Module(BaseProtocol);
 
 const int BaseProtocol::BEACON_TYPE = 12345;
+const int BaseProtocol::AGGREGATED_BEACON_TYPE = 12346;
 
 void BaseProtocol::initialize(int stage)
 {
@@ -48,6 +51,7 @@ void BaseProtocol::initialize(int stage)
         channelBusy = false;
         nCollisions = 0;
         busyTime = SimTime(0);
+        totalBusyTime = SimTime(0);
         seq_n = 0;
         recordData = 0;
 
@@ -76,6 +80,19 @@ void BaseProtocol::initialize(int stage)
         // priority of platooning message
         priority = par("priority");
         ASSERT2(priority >= 0 && priority <= 7, "priority value must be between 0 and 7");
+        directDelivery = par("directDelivery");
+        compactBeacons = par("compactBeacons");
+        compactHeading = par("compactHeading");
+        keyBeaconPeriod = par("keyBeaconPeriod");
+        keySequenceNumber = -1;
+        keyPositionX = 0;
+        keyPositionY = 0;
+        beaconsSinceKey = 0;
+        nUndecodable = 0;
+        summaryStatistics = par("summaryStatistics");
+        summarySnapshotInterval = SimTime(par("summarySnapshotInterval").doubleValue());
+        totalCollisions = 0;
+        totalUndecodable = 0;
 
         // init messages for scheduleAt
         sendBeacon = new cMessage("sendBeacon");
@@ -88,13 +105,23 @@ void BaseProtocol::initialize(int stage)
         busyTimeOut.setName("busyTime");
         // mac layer collisions
         collisionsOut.setName("collisions");
+        // compact beacons that could not be decoded
+        undecodableOut.setName("undecodableBeacons");
         // delay metrics
-        lastLeaderMsgTime = SimTime(-1);
-        lastFrontMsgTime = SimTime(-1);
         leaderDelayIdOut.setName("leaderDelayId");
         frontDelayIdOut.setName("frontDelayId");
         leaderDelayOut.setName("leaderDelay");
         frontDelayOut.setName("frontDelay");
+        if (summaryStatistics) {
+            initSummary(leaderDelaySummary, "leaderDelay");
+            initSummary(frontDelaySummary, "frontDelay");
+            initSummary(interArrivalSummary, "interArrival");
+            initSummary(busyRatioSummary, "busyRatio");
+            if (summarySnapshotInterval > 0) {
+                summarySnapshot = new cMessage("summarySnapshot");
+                scheduleAt(simTime() + summarySnapshotInterval, summarySnapshot);
+            }
+        }
 
         // subscribe to signals for channel busy state and collisions
         findHost()->subscribe(veins::Mac1609_4::sigChannelBusy, this);
@@ -135,6 +162,61 @@ BaseProtocol::~BaseProtocol()
     sendBeacon = nullptr;
     cancelAndDelete(recordData);
     recordData = nullptr;
+    cancelAndDelete(summarySnapshot);
+    summarySnapshot = nullptr;
+}
+
+void BaseProtocol::finish()
+{
+    if (summaryStatistics) {
+        recordSummary("leaderDelay", leaderDelaySummary.histogram);
+        recordSummary("frontDelay", frontDelaySummary.histogram);
+        recordSummary("interArrival", interArrivalSummary.histogram);
+        recordSummary("busyRatio", busyRatioSummary.histogram);
+        recordScalar("collisions", totalCollisions);
+        if (compactBeacons) recordScalar("undecodableBeacons", totalUndecodable);
+    }
+    BaseApplLayer::finish();
+}
+
+void BaseProtocol::initSummary(SummaryStatistic& summary, const char* name)
+{
+    summary.name = name;
+    summary.p50Out.setName((summary.name + "P50").c_str());
+    summary.p95Out.setName((summary.name + "P95").c_str());
+    summary.p99Out.setName((summary.name + "P99").c_str());
+    summary.maxOut.setName((summary.name + "Max").c_str());
+    // the global summary lives in the manager, which also gets the values of
+    // vehicles that left the simulation and records it once, at the end
+    auto plexe = FindModule<PlexeManager*>::findGlobalModule();
+    ASSERT(plexe);
+    summary.global = &plexe->getGlobalSummary(summary.name);
+}
+
+void BaseProtocol::collectSummary(SummaryStatistic& summary, double value)
+{
+    summary.histogram.collect(value);
+    summary.global->collect(value);
+}
+
+void BaseProtocol::snapshotSummary(SummaryStatistic& summary)
+{
+    if (summary.histogram.getCount() == 0) return;
+    summary.p50Out.record(summary.histogram.getQuantile(0.5));
+    summary.p95Out.record(summary.histogram.getQuantile(0.95));
+    summary.p99Out.record(summary.histogram.getQuantile(0.99));
+    summary.maxOut.record(summary.histogram.getMax());
+}
+
+void BaseProtocol::recordSummary(const std::string& name, const LogLinearHistogram& histogram)
+{
+    recordScalar((name + "Count").c_str(), histogram.getCount());
+    if (histogram.getCount() == 0) return;
+    recordScalar((name + "Mean").c_str(), histogram.getMean());
+    recordScalar((name + "P50").c_str(), histogram.getQuantile(0.5));
+    recordScalar((name + "P95").c_str(), histogram.getQuantile(0.95));
+    recordScalar((name + "P99").c_str(), histogram.getQuantile(0.99));
+    recordScalar((name + "Max").c_str(), histogram.getMax());
 }
 
 void BaseProtocol::handleSelfMsg(cMessage* msg)
@@ -147,23 +229,41 @@ void BaseProtocol::handleSelfMsg(cMessage* msg)
         // up to now, and then reset the "startBusy" timer to now
         if (channelBusy) {
             busyTime += simTime() - startBusy;
+            totalBusyTime += simTime() - startBusy;
             startBusy = simTime();
         }
 
-        // time for writing statistics
-        // node id
-        nodeIdOut.record(myId);
-        // record busy time for this period
-        busyTimeOut.record(busyTime);
-        // record collisions for this period
-        collisionsOut.record(nCollisions);
+        if (summaryStatistics) {
+            // statistics periods are one second long
+            collectSummary(busyRatioSummary, busyTime.dbl());
+            totalCollisions += nCollisions;
+            totalUndecodable += nUndecodable;
+        }
+        else {
+            // time for writing statistics
+            // node id
+            nodeIdOut.record(myId);
+            // record busy time for this period
+            busyTimeOut.record(busyTime);
+            // record collisions for this period
+            collisionsOut.record(nCollisions);
+            if (compactBeacons) undecodableOut.record(nUndecodable);
+        }
 
         // and reset counter
         busyTime = SimTime(0);
         nCollisions = 0;
+        nUndecodable = 0;
 
         scheduleAt(simTime() + SimTime(1, SIMTIME_S), recordData);
     }
+    if (msg == summarySnapshot) {
+        snapshotSummary(leaderDelaySummary);
+        snapshotSummary(frontDelaySummary);
+        snapshotSummary(interArrivalSummary);
+        snapshotSummary(busyRatioSummary);
+        scheduleAt(simTime() + summarySnapshotInterval, summarySnapshot);
+    }
 }
 
 void BaseProtocol::sendPlatooningMessage(int destinationAddress, enum PlexeRadioInterfaces interfaces)
@@ -173,14 +273,22 @@ void BaseProtocol::sendPlatooningMessage(int destinationAddress, enum PlexeRadio
 
 void BaseProtocol::sendTo(BaseFrame1609_4* frame, enum PlexeRadioInterfaces interfaces)
 {
+    // copies are only needed for all but the last interface, which gets the original frame
+    cGate* last = nullptr;
     for (auto interface : radioOuts) {
         if (interface.first & interfaces) {
-            BaseFrame1609_4* dup = frame->dup();
-            if (frame->getControlInfo()) dup->setControlInfo(frame->getControlInfo()->dup());
-            send(dup, interface.second);
+            if (last) {
+                BaseFrame1609_4* dup = frame->dup();
+                if (frame->getControlInfo()) dup->setControlInfo(frame->getControlInfo()->dup());
+                send(dup, last);
+            }
+            last = interface.second;
         }
     }
-    delete frame;
+    if (last)
+        send(frame, last);
+    else
+        delete frame;
 }
 
 std::unique_ptr<BaseFrame1609_4> BaseProtocol::createBeacon(int destinationAddress)
@@ -189,10 +297,14 @@ std::unique_ptr<BaseFrame1609_4> BaseProtocol::createBeacon(int destinationAddre
     VEHICLE_DATA data;
     // get information about the vehicle via traci
     plexeTraciVehicle->getVehicleData(&data);
+    return createBeacon(destinationAddress, data);
+}
 
+std::unique_ptr<BaseFrame1609_4> BaseProtocol::createBeacon(int destinationAddress, const VEHICLE_DATA& data)
+{
     // create and send beacon
     auto wsm = veins::make_unique<BaseFrame1609_4>("", BEACON_TYPE);
-    wsm->setRecipientAddress(LAddress::L2BROADCAST());
+    wsm->setRecipientAddress(destinationAddress < 0 ? LAddress::L2BROADCAST() : destinationAddress);
     wsm->setChannelNumber(static_cast<int>(Channel::cch));
     wsm->setUserPriority(priority);
 
@@ -213,20 +325,148 @@ std::unique_ptr<BaseFrame1609_4> BaseProtocol::createBeacon(int destinationAddre
     pkt->setKind(BEACON_TYPE);
     pkt->setByteLength(packetSize);
     pkt->setSequenceNumber(seq_n++);
+    if (compactBeacons) encodeCompactBeacon(pkt);
 
     wsm->encapsulate(pkt);
 
     return wsm;
 }
 
+namespace {
+
+// resolution of the fields in compact beacons
+const double speedStep = 0.01; // cm/s
+const double accelerationStep = 0.001; // mm/s^2
+const double positionStep = 0.01; // cm
+const double timeStep = 0.001; // ms
+const double lengthStep = 0.01; // cm
+const double angleStep = 2 * M_PI / 65536; // 16 bits for a full turn
+// largest offset from the reference position fitting in 16 bits
+const double maxPositionOffset = 32767 * positionStep;
+
+double quantize(double value, double step)
+{
+    return std::round(value / step) * step;
+}
+
+} // namespace
+
+void BaseProtocol::encodeCompactBeacon(PlatooningBeacon* pkt)
+{
+    pkt->setSpeed(quantize(pkt->getSpeed(), speedStep));
+    pkt->setAcceleration(quantize(pkt->getAcceleration(), accelerationStep));
+    pkt->setControllerAcceleration(quantize(pkt->getControllerAcceleration(), accelerationStep));
+    pkt->setTime(quantize(pkt->getTime(), timeStep));
+    pkt->setLength(quantize(pkt->getLength(), lengthStep));
+
+    // flags, vehicle id (16 bits), sequence number (32 bits), speed and
+    // accelerations (16 bits each), time (32 bits), length (16 bits)
+    int bits = 8 + 16 + 32 + 3 * 16 + 32 + 16;
+
+    double x = quantize(pkt->getPositionX(), positionStep);
+    double y = quantize(pkt->getPositionY(), positionStep);
+    double dx = quantize(x - keyPositionX, positionStep);
+    double dy = quantize(y - keyPositionY, positionStep);
+    if (keySequenceNumber >= 0 && beaconsSinceKey < keyBeaconPeriod && std::abs(dx) <= maxPositionOffset && std::abs(dy) <= maxPositionOffset) {
+        // offset from the last absolute position (16 bits each) and the
+        // sequence number it refers to (16 bits)
+        pkt->setPositionX(dx);
+        pkt->setPositionY(dy);
+        pkt->setPositionReference(keySequenceNumber);
+        beaconsSinceKey++;
+        bits += 3 * 16;
+    }
+    else {
+        // absolute position (32 bits each)
+        pkt->setPositionX(x);
+        pkt->setPositionY(y);
+        keySequenceNumber = pkt->getSequenceNumber();
+        keyPositionX = x;
+        keyPositionY = y;
+        beaconsSinceKey = 0;
+        bits += 2 * 32;
+    }
+
+    if (compactHeading) {
+        // speed components (16 bits each) and angle (16 bits)
+        pkt->setSpeedX(quantize(pkt->getSpeedX(), speedStep));
+        pkt->setSpeedY(quantize(pkt->getSpeedY(), speedStep));
+        pkt->setAngle(quantize(pkt->getAngle(), angleStep));
+        bits += 3 * 16;
+    }
+    else {
+        pkt->setSpeedX(0);
+        pkt->setSpeedY(0);
+        pkt->setAngle(0);
+    }
+
+    pkt->setByteLength((bits + 7) / 8);
+}
+
+bool BaseProtocol::decodeCompactBeacon(PlatooningBeacon* pkt, NeighborState& sender)
+{
+    if (pkt->getPositionReference() < 0) {
+        // absolute position, which the next beacons might refer to
+        sender.keySequenceNumber = pkt->getSequenceNumber();
+        sender.keyPositionX = pkt->getPositionX();
+        sender.keyPositionY = pkt->getPositionY();
+        return true;
+    }
+    if (sender.keySequenceNumber != pkt->getPositionReference()) return false;
+    pkt->setPositionX(sender.keyPositionX + pkt->getPositionX());
+    pkt->setPositionY(sender.keyPositionY + pkt->getPositionY());
+    pkt->setPositionReference(-1);
+    return true;
+}
+
 bool BaseProtocol::isDuplicated(const PlatooningBeacon* beacon)
 {
-    auto sequenceNumber = knownBeacons.find(beacon->getVehicleId());
-    if (sequenceNumber == knownBeacons.end()) return false;
-    if (beacon->getSequenceNumber() > sequenceNumber->second) return false;
+    const NeighborState* neighbor = getNeighborState(beacon->getVehicleId());
+    if (!neighbor) return false;
+    if (beacon->getSequenceNumber() > neighbor->sequenceNumber) return false;
     return true;
 }
 
+const NeighborState* BaseProtocol::getNeighborState(int vehicleId) const
+{
+    if (vehicleId < 0 || vehicleId >= (int) neighbors.size()) return nullptr;
+    const NeighborState& neighbor = neighbors[vehicleId];
+    return neighbor.received > 0 ? &neighbor : nullptr;
+}
+
+void BaseProtocol::updateNeighbor(NeighborState& neighbor, const PlatooningBeacon* beacon)
+{
+    if (neighbor.received > 0) {
+        neighbor.lastInterArrival = simTime() - neighbor.lastReception;
+        // incremental mean over the received - 1 inter-arrival times
+        neighbor.meanInterArrival += (neighbor.lastInterArrival.dbl() - neighbor.meanInterArrival) / neighbor.received;
+    }
+    neighbor.received++;
+    neighbor.sequenceNumber = beacon->getSequenceNumber();
+    neighbor.lastReception = simTime();
+
+    struct VEHICLE_DATA& data = neighbor.data;
+    data.index = positionHelper->isInSamePlatoon(beacon->getVehicleId()) ? positionHelper->getMemberPosition(beacon->getVehicleId()) : -1;
+    data.speed = beacon->getSpeed();
+    data.acceleration = beacon->getAcceleration();
+    data.positionX = beacon->getPositionX();
+    data.positionY = beacon->getPositionY();
+    data.time = beacon->getTime();
+    data.length = beacon->getLength();
+    data.u = beacon->getControllerAcceleration();
+    data.speedX = beacon->getSpeedX();
+    data.speedY = beacon->getSpeedY();
+    data.angle = beacon->getAngle();
+}
+
+SimTime BaseProtocol::getTotalBusyTime() const
+{
+    if (channelBusy)
+        return totalBusyTime + simTime() - startBusy;
+    else
+        return totalBusyTime;
+}
+
 void BaseProtocol::receiveSignal(cComponent* source, simsignal_t signalID, bool v, cObject* details)
 {
 
@@ -242,6 +482,7 @@ void BaseProtocol::receiveSignal(cComponent* source, simsignal_t signalID, bool
         if (!v && channelBusy) {
             // channel turned idle, was busy before
             busyTime += simTime() - startBusy;
+            totalBusyTime += simTime() - startBusy;
             channelBusy = false;
             channelIdleStart();
             return;
@@ -273,7 +514,8 @@ void BaseProtocol::handleLowerMsg(cMessage* msg)
     cPacket* enc = frame->getEncapsulatedPacket();
     ASSERT2(enc, "received a BaseFrame1609_4 with nothing inside");
 
-    if (PlatooningBeacon* epkt = dynamic_cast<PlatooningBeacon*>(enc)) {
+    if (enc->getKind() == BEACON_TYPE) {
+        PlatooningBeacon* epkt = static_cast<PlatooningBeacon*>(enc);
 
         // if we're using multiple radios simultaneously, we might get duplicated beacons
         if (isDuplicated(epkt)) {
@@ -281,36 +523,57 @@ void BaseProtocol::handleLowerMsg(cMessage* msg)
             delete frame;
             return;
         }
-        knownBeacons[epkt->getVehicleId()] = epkt->getSequenceNumber();
+        int sender = epkt->getVehicleId();
+        if (sender < 0) throw cRuntimeError("BaseProtocol: received a beacon with invalid vehicle id %d", sender);
+        if (sender >= (int) neighbors.size()) neighbors.resize(sender + 1);
+        NeighborState& neighbor = neighbors[sender];
+        if (!decodeCompactBeacon(epkt, neighbor)) {
+            nUndecodable++;
+            delete frame;
+            return;
+        }
+        updateNeighbor(neighbor, epkt);
 
         // invoke messageReceived() method of subclass
         messageReceived(epkt, frame);
 
-        if (positionHelper->getLeaderId() == epkt->getVehicleId()) {
-            // check if this is at least the second message we have received
-            if (lastLeaderMsgTime.dbl() > 0) {
-                leaderDelayOut.record(simTime() - lastLeaderMsgTime);
+        // record the delay between each pair of messages received from leader and car in front
+        if (neighbor.received > 1 && summaryStatistics) {
+            collectSummary(interArrivalSummary, neighbor.lastInterArrival.dbl());
+            if (positionHelper->getLeaderId() == sender) collectSummary(leaderDelaySummary, neighbor.lastInterArrival.dbl());
+            if (positionHelper->getFrontId() == sender) collectSummary(frontDelaySummary, neighbor.lastInterArrival.dbl());
+        }
+        else if (neighbor.received > 1) {
+            if (positionHelper->getLeaderId() == sender) {
+                leaderDelayOut.record(neighbor.lastInterArrival);
                 leaderDelayIdOut.record(myId);
             }
-            lastLeaderMsgTime = simTime();
-        }
-        if (positionHelper->getFrontId() == epkt->getVehicleId()) {
-            // check if this is at least the second message we have received
-            if (lastFrontMsgTime.dbl() > 0) {
-                frontDelayOut.record(simTime() - lastFrontMsgTime);
+            if (positionHelper->getFrontId() == sender) {
+                frontDelayOut.record(neighbor.lastInterArrival);
                 frontDelayIdOut.record(myId);
             }
-            lastFrontMsgTime = simTime();
         }
     }
 
     // find the application responsible for this beacon
     ApplicationMap::iterator app = apps.find(frame->getKind());
     if (app != apps.end() && app->second.size() != 0) {
-        AppList applications = app->second;
-        for (AppList::iterator i = applications.begin(); i != applications.end(); i++) {
-            // send the message to the applications responsible for it
-            send(frame->dup(), std::get<1>(*i));
+        const AppList& applications = app->second;
+        // applications listening for frames directly all read the same
+        // frame. the others get a copy through their gate, except for the
+        // last one which gets the original frame
+        const AppInOut* last = nullptr;
+        for (const AppInOut& application : applications) {
+            if (FrameListener* listener = std::get<4>(application)) {
+                listener->onFrameReceived(frame);
+                continue;
+            }
+            if (last) send(frame->dup(), std::get<1>(*last));
+            last = &application;
+        }
+        if (last) {
+            send(frame, std::get<1>(*last));
+            return;
         }
     }
     delete frame;
@@ -338,7 +601,7 @@ void BaseProtocol::duplicatedMessageReceived(PlatooningBeacon* pkt, BaseFrame160
 {
 }
 
-void BaseProtocol::registerApplication(int applicationId, InputGate* appInputGate, OutputGate* appOutputGate, ControlInputGate* appControlInputGate, ControlOutputGate* appControlOutputGate)
+void BaseProtocol::registerApplication(int applicationId, InputGate* appInputGate, OutputGate* appOutputGate, ControlInputGate* appControlInputGate, ControlOutputGate* appControlOutputGate, FrameListener* listener)
 {
     if (usedGates == MAX_GATES_COUNT) throw cRuntimeError("BaseProtocol: application with id=%d tried to register, but no space left", applicationId);
     // connect gates, if not already connected. a gate might be already
@@ -380,7 +643,7 @@ void BaseProtocol::registerApplication(int applicationId, InputGate* appInputGat
         upperCntOut = gate->second;
     }
     // save the mapping in the connection
-    apps[applicationId].push_back(AppInOut(upperIn, upperOut, upperCntIn, upperCntOut));
+    apps[applicationId].push_back(AppInOut(upperIn, upperOut, upperCntIn, upperCntOut, directDelivery ? listener : nullptr));
 }
 
 } // namespace plexe
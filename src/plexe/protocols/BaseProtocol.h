@@ -25,9 +25,11 @@
 #include "veins/modules/mobility/traci/TraCIMobility.h"
 #include "veins/modules/messages/BaseFrame1609_4_m.h"
 
+#include "plexe/CC_Const.h"
 #include "plexe/messages/PlatooningBeacon_m.h"
 #include "plexe/mobility/CommandInterface.h"
 #include "plexe/utilities/BasePositionHelper.h"
+#include "plexe/utilities/LogLinearHistogram.h"
 
 #include "plexe/driver/PlexeRadioDriverInterface.h"
 
@@ -41,11 +43,60 @@ namespace plexe {
 
 using veins::BaseFrame1609_4;
 
+/**
+ * Interface for applications that want received frames to be delivered by a
+ * direct method call instead of through their lower layer gate. This avoids
+ * duplicating a frame for each application registered for the same type
+ */
+class FrameListener {
+public:
+    virtual ~FrameListener()
+    {
+    }
+
+    /**
+     * Invoked by the protocol for each received frame the application has
+     * registered for. The frame is owned by the protocol and is shared with
+     * the other applications, so it must only be read, and only during the
+     * call
+     *
+     * \param frame the received frame
+     */
+    virtual void onFrameReceived(const BaseFrame1609_4* frame) = 0;
+};
+
+/**
+ * What a protocol knows about another vehicle, based on the beacons it
+ * received from it
+ */
+struct NeighborState {
+    // number of beacons received, duplicates excluded
+    int received = 0;
+    // sequence number of the last beacon received
+    int sequenceNumber = -1;
+    // reception time of the last beacon
+    SimTime lastReception;
+    // time between the receptions of the last two beacons
+    SimTime lastInterArrival;
+    // average time between two receptions
+    double meanInterArrival = 0;
+    // content of the last beacon. index is the sender's position in our
+    // platoon, or -1 if it is not a member
+    struct VEHICLE_DATA data = {};
+    // last beacon with an absolute position, which compact beacons can
+    // refer to (sequence number and position)
+    int keySequenceNumber = -1;
+    double keyPositionX = 0;
+    double keyPositionY = 0;
+};
+
 class BaseProtocol : public veins::BaseApplLayer {
 
 private:
     // amount of time channel has been observed busy during the last "statisticsPeriod" seconds
     SimTime busyTime;
+    // amount of time channel has been observed busy since the beginning of the simulation
+    SimTime totalBusyTime;
     // count the number of collision at the phy layer
     int nCollisions;
     // time at which channel turned busy
@@ -53,10 +104,6 @@ private:
     // indicates whether channel is busy or not
     bool channelBusy;
 
-    // record the delay between each pair of messages received from leader and car in front
-    SimTime lastLeaderMsgTime;
-    SimTime lastFrontMsgTime;
-
     // own id for statistics
     cOutVector nodeIdOut;
 
@@ -66,15 +113,52 @@ private:
     // output vector for delays
     cOutVector leaderDelayIdOut, frontDelayIdOut, leaderDelayOut, frontDelayOut;
 
+    /**
+     * Streaming summary of a metric, used instead of output vectors when
+     * summaryStatistics is enabled. Quantiles are recorded as scalars at
+     * the end of the simulation and, optionally, periodically into vectors
+     */
+    struct SummaryStatistic {
+        std::string name;
+        LogLinearHistogram histogram;
+        // summary of the metric over all vehicles, owned by the PlexeManager
+        LogLinearHistogram* global = nullptr;
+        cOutVector p50Out, p95Out, p99Out, maxOut;
+    };
+    SummaryStatistic leaderDelaySummary, frontDelaySummary, interArrivalSummary, busyRatioSummary;
+    // total number of collisions and of undecodable beacons, for the summary
+    long totalCollisions;
+    long totalUndecodable;
+
+    void initSummary(SummaryStatistic& summary, const char* name);
+    // adds a value to the summary of this vehicle and to the global one
+    void collectSummary(SummaryStatistic& summary, double value);
+    void snapshotSummary(SummaryStatistic& summary);
+    void recordSummary(const std::string& name, const LogLinearHistogram& histogram);
+
+    // count and output vector of compact beacons dropped because the
+    // beacon their position refers to was not received
+    int nUndecodable;
+    cOutVector undecodableOut;
+
     // map of radio interfaces from radio ids
     std::map<int, cGate*> radioOuts;
 
-    // map of known beacons (vehicle id, sequence number)
-    std::map<int, int> knownBeacons;
+    // state of the vehicles we received beacons from, indexed by vehicle
+    // id. ids are small consecutive integers, so a vector is enough
+    std::vector<NeighborState> neighbors;
 
     // indicates whether a beacon has already been received or not
     bool isDuplicated(const PlatooningBeacon* beacon);
 
+    // updates the state of the sender of a beacon
+    void updateNeighbor(NeighborState& neighbor, const PlatooningBeacon* beacon);
+
+    // last beacon sent with an absolute position, for compact encoding
+    int keySequenceNumber;
+    double keyPositionX, keyPositionY;
+    int beaconsSinceKey;
+
 protected:
     // determines position and role of each vehicle
     BasePositionHelper* positionHelper;
@@ -92,6 +176,14 @@ protected:
     int priority;
     // packet size of the platooning message
     int packetSize;
+    // quantize beacon fields and compute the packet size from the fields
+    // actually sent, instead of using packetSize
+    bool compactBeacons;
+    // whether compact beacons include speedX, speedY, and angle
+    bool compactHeading;
+    // maximum number of compact beacons with a relative position between
+    // two beacons with an absolute one
+    int keyBeaconPeriod;
 
     // input/output gates from/to upper layer
     int upperControlIn, upperControlOut, lowerLayerIn, lowerLayerOut;
@@ -102,17 +194,26 @@ protected:
 
     // registered upper layer applications. this is a mapping between
     // beacon id inside packets coming from upper layer and the gate they
-    // the application is connected to. convention: id, from app, to app
+    // the application is connected to. convention: id, from app, to app.
+    // the listener is set only for applications receiving frames directly
     typedef cGate OutputGate;
     typedef cGate InputGate;
     typedef cGate ControlInputGate;
     typedef cGate ControlOutputGate;
-    typedef std::tuple<InputGate*, OutputGate*, ControlInputGate*, ControlOutputGate*> AppInOut;
+    typedef std::tuple<InputGate*, OutputGate*, ControlInputGate*, ControlOutputGate*, FrameListener*> AppInOut;
     typedef std::vector<AppInOut> AppList;
     typedef std::map<int, AppList> ApplicationMap;
     ApplicationMap apps;
     // number of gates from the array used
     int usedGates;
+    // keep streaming summaries of delays and busy ratio instead of
+    // recording every sample into output vectors
+    bool summaryStatistics;
+    // interval at which summaries are recorded into vectors. 0 to disable
+    SimTime summarySnapshotInterval;
+    // deliver received frames to applications implementing FrameListener
+    // with a method call rather than sending a copy to each of them
+    bool directDelivery;
     // maps of already existing connections
     typedef cGate ThisGate;
     typedef cGate OtherGate;
@@ -122,6 +223,7 @@ protected:
     // messages for scheduleAt
     cMessage* sendBeacon;
     cMessage* recordData;
+    cMessage* summarySnapshot;
 
     /**
      * NB: this method must be overridden by inheriting classes, BUT THEY MUST invoke the super class
@@ -156,7 +258,35 @@ protected:
      */
     void sendPlatooningMessage(int destinationAddress, enum PlexeRadioInterfaces interfaces = PlexeRadioInterfaces::ALL);
 
-    virtual std::unique_ptr<BaseFrame1609_4> createBeacon(int destinationAddress);
+    // creates a beacon with the current data of the vehicle
+    std::unique_ptr<BaseFrame1609_4> createBeacon(int destinationAddress);
+
+    /**
+     * Creates a beacon with the given data, e.g., when the caller already
+     * fetched it. Subclasses customizing beacons should override this
+     */
+    virtual std::unique_ptr<BaseFrame1609_4> createBeacon(int destinationAddress, const VEHICLE_DATA& data);
+
+    /**
+     * Quantizes the fields of a beacon as they would be sent with the
+     * compact encoding, turning the position into an offset from the last
+     * beacon with an absolute position when possible, and sets its size
+     * accordingly
+     *
+     * \param pkt the beacon to encode
+     */
+    virtual void encodeCompactBeacon(PlatooningBeacon* pkt);
+
+    /**
+     * Restores the absolute position of a compact beacon carrying a
+     * relative one. Absolute positions are stored in the state of the
+     * sender as reference for the next beacons
+     *
+     * \param pkt the beacon to decode
+     * \param sender the state of the sender of the beacon
+     * \return false if the beacon the position refers to was not received
+     */
+    virtual bool decodeCompactBeacon(PlatooningBeacon* pkt, NeighborState& sender);
 
     /**
      * This method must be overridden by subclasses to take decisions
@@ -197,6 +327,13 @@ protected:
     {
     }
 
+    /**
+     * Returns the amount of time the channel has been observed busy since
+     * the beginning of the simulation, including the current busy period
+     * if the channel is busy now
+     */
+    SimTime getTotalBusyTime() const;
+
     // traci mobility. used for getting/setting info about the car
     veins::TraCIMobility* mobility;
     veins::TraCICommandInterface* traci;
@@ -207,19 +344,33 @@ protected:
 public:
     // id for beacon message
     static const int BEACON_TYPE;
+    // id for beacons aggregating the state of a whole platoon
+    static const int AGGREGATED_BEACON_TYPE;
 
     BaseProtocol()
     {
         sendBeacon = nullptr;
         recordData = nullptr;
+        summarySnapshot = nullptr;
         usedGates = 0;
+        directDelivery = false;
     }
     virtual ~BaseProtocol();
 
     virtual void initialize(int stage) override;
+    virtual void finish() override;
+
+    /**
+     * Returns what is known about another vehicle from its beacons, or
+     * nullptr if no beacon has been received from it yet. The pointer is
+     * valid until the next beacon is received
+     */
+    const NeighborState* getNeighborState(int vehicleId) const;
 
-    // register a higher level application by its id
-    void registerApplication(int applicationId, InputGate* appInputGate, OutputGate* appOutputGate, ControlInputGate* appControlInputGate, ControlOutputGate* appControlOutputGate);
+    // register a higher level application by its id. if a listener is given
+    // and direct delivery is enabled, received frames are passed to it
+    // instead of being sent through the gates
+    void registerApplication(int applicationId, InputGate* appInputGate, OutputGate* appOutputGate, ControlInputGate* appControlInputGate, ControlOutputGate* appControlOutputGate, FrameListener* listener = nullptr);
 };
 
 } // namespace plexe
@@ -0,0 +1,179 @@
+//
+// Copyright (C) 2021 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+
+#include "CoordinatedSlottedBeaconing.h"
+
+namespace plexe {
+
+Define_Module(CoordinatedSlottedBeaconing)
+
+void CoordinatedSlottedBeaconing::initialize(int stage)
+{
+    SlottedBeaconing::initialize(stage);
+
+    if (stage == 0) {
+        slotDuration = SimTime(par("slotDuration").doubleValue());
+        ASSERT2(slotDuration > 0, "slotDuration must be positive");
+        nSlots = (int) floor(beaconingInterval / slotDuration);
+        reservationTimeout = SimTime(par("reservationTimeout").doubleValue());
+
+        slotOwner = -1;
+        slotOffset = -1;
+        slotCount = 0;
+
+        slotOffsetOut.setName("slotOffset");
+    }
+}
+
+void CoordinatedSlottedBeaconing::handleSelfMsg(cMessage* msg)
+{
+
+    // the slotted beaconing logic is replaced, so skip the direct parent
+    BaseProtocol::handleSelfMsg(msg);
+
+    if (msg == sendBeacon) {
+        if (positionHelper->isLeader()) {
+            // the first beacon is sent at a random time, after listening to
+            // the channel for one beacon interval. from then on, the leader
+            // sends at the beginning of its block of slots
+            updateReservation();
+            sendPlatooningMessage(-1);
+            scheduleAt(getNextSlotStart(slotOffset), sendBeacon);
+        }
+        else {
+            sendPlatooningMessage(-1);
+            // if the next beacon of the leader is received, this is
+            // rescheduled relative to it
+            scheduleAt(simTime() + beaconingInterval, sendBeacon);
+        }
+    }
+}
+
+void CoordinatedSlottedBeaconing::messageReceived(PlatooningBeacon* pkt, BaseFrame1609_4* frame)
+{
+
+    int senderId = pkt->getVehicleId();
+    int leaderId = positionHelper->getLeaderId();
+
+    // keep track of the slots used by other platoons
+    if (pkt->getSlotOwner() >= 0 && pkt->getSlotOwner() != leaderId) {
+        Reservation& reservation = reservations[pkt->getSlotOwner()];
+        reservation.offset = pkt->getSlotOffset();
+        reservation.count = pkt->getSlotCount();
+        reservation.lastHeard = simTime();
+    }
+
+    if (senderId == leaderId && !positionHelper->isLeader()) {
+        // synchronize on the leader, sending in our slot of its block
+        slotOwner = pkt->getSlotOwner();
+        slotOffset = pkt->getSlotOffset();
+        slotCount = pkt->getSlotCount();
+        if (sendBeacon->isScheduled()) cancelEvent(sendBeacon);
+        scheduleAt(simTime() + getSlotInBlock(positionHelper->getPosition()) * slotDuration, sendBeacon);
+    }
+}
+
+std::unique_ptr<BaseFrame1609_4> CoordinatedSlottedBeaconing::createBeacon(int destinationAddress, const VEHICLE_DATA& data)
+{
+    std::unique_ptr<BaseFrame1609_4> frame = SlottedBeaconing::createBeacon(destinationAddress, data);
+    PlatooningBeacon* pkt = check_and_cast<PlatooningBeacon*>(frame->getEncapsulatedPacket());
+    pkt->setSlotOwner(slotOwner);
+    pkt->setSlotOffset(slotOffset);
+    pkt->setSlotCount(slotCount);
+    return frame;
+}
+
+void CoordinatedSlottedBeaconing::updateReservation()
+{
+    for (auto reservation = reservations.begin(); reservation != reservations.end();) {
+        if (simTime() - reservation->second.lastHeard > reservationTimeout)
+            reservation = reservations.erase(reservation);
+        else
+            reservation++;
+    }
+
+    int count = std::min(positionHelper->getPlatoonSize(), nSlots);
+    bool conflict = slotOwner != myId || slotOffset < 0 || slotOffset + count > nSlots;
+    if (!conflict) {
+        // the leader with the lower id keeps its slots
+        for (const auto& reservation : reservations) {
+            const Reservation& other = reservation.second;
+            if (reservation.first < myId && slotOffset < other.offset + other.count && other.offset < slotOffset + count) {
+                conflict = true;
+                break;
+            }
+        }
+    }
+    slotOwner = myId;
+    slotCount = count;
+    if (!conflict) return;
+
+    // take the first free block. if none is free, keep the current one
+    // (or the first, if the current one does not fit anymore) and wait for
+    // other platoons to leave
+    int offset = 0;
+    while (offset + count <= nSlots && !isFree(offset, count))
+        offset++;
+    if (offset + count <= nSlots)
+        slotOffset = offset;
+    else if (slotOffset < 0 || slotOffset + count > nSlots)
+        slotOffset = 0;
+    slotOffsetOut.record(slotOffset);
+}
+
+bool CoordinatedSlottedBeaconing::isFree(int offset, int count) const
+{
+    for (const auto& reservation : reservations) {
+        const Reservation& other = reservation.second;
+        if (offset < other.offset + other.count && other.offset < offset + count) return false;
+    }
+    return true;
+}
+
+int CoordinatedSlottedBeaconing::getSlotInBlock(int position) const
+{
+    if (position < slotCount) return position;
+    // the block is smaller than the platoon. wrap the followers around the
+    // slots of the block except the one of the leader, whose data every
+    // follower needs. beacons of the followers sharing a slot might collide,
+    // but the slots of other platoons are left alone
+    if (slotCount > 1) return 1 + (position - 1) % (slotCount - 1);
+    return 0;
+}
+
+SimTime CoordinatedSlottedBeaconing::getNextSlotStart(int slot) const
+{
+    // slots are aligned to multiples of the beaconing interval
+    SimTime frameStart = SimTime(floor(simTime() / beaconingInterval) * beaconingInterval.dbl());
+    SimTime slotStart = frameStart + slot * slotDuration;
+    if (slotStart <= simTime()) slotStart += beaconingInterval;
+    return slotStart;
+}
+
+CoordinatedSlottedBeaconing::CoordinatedSlottedBeaconing()
+{
+}
+
+CoordinatedSlottedBeaconing::~CoordinatedSlottedBeaconing()
+{
+}
+
+} // namespace plexe
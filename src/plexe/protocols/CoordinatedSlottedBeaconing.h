@@ -0,0 +1,97 @@
+//
+// Copyright (C) 2021 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+
+#ifndef COORDINATEDSLOTTEDBEACONING_H_
+#define COORDINATEDSLOTTEDBEACONING_H_
+
+#include "SlottedBeaconing.h"
+
+namespace plexe {
+
+/**
+ * Slotted beaconing where the platoons within communication range use
+ * non-overlapping slots. The beaconing interval is divided into slots of
+ * fixed duration, aligned to multiples of the beaconing interval. The
+ * leader of each platoon reserves a block of consecutive slots, one for
+ * each member, and advertises it in the beacons, which followers echo.
+ * When two reservations overlap, the platoon whose leader has the higher
+ * id moves to the first free block. The block is checked before every
+ * beacon of the leader, so it follows changes in the platoon size. If the
+ * platoon has more members than slots in the interval, the followers
+ * beyond the block share its follower slots rather than using the slots
+ * of other platoons
+ */
+class CoordinatedSlottedBeaconing : public SlottedBeaconing {
+protected:
+    virtual void handleSelfMsg(cMessage* msg) override;
+    virtual void messageReceived(PlatooningBeacon* pkt, veins::BaseFrame1609_4* frame) override;
+    using BaseProtocol::createBeacon;
+    virtual std::unique_ptr<BaseFrame1609_4> createBeacon(int destinationAddress, const VEHICLE_DATA& data) override;
+
+    /**
+     * Checks the reservation of our platoon against the ones heard from
+     * other platoons, moving it to a free block in case of conflict.
+     * Only invoked by the leader
+     */
+    virtual void updateReservation();
+
+    // returns whether the given block does not overlap with reservations of other platoons
+    bool isFree(int offset, int count) const;
+
+    // returns the next time at which the given slot starts
+    SimTime getNextSlotStart(int slot) const;
+
+    // returns the slot of the given platoon position within the block of the leader
+    int getSlotInBlock(int position) const;
+
+    struct Reservation {
+        int offset;
+        int count;
+        SimTime lastHeard;
+    };
+
+    // reservations of other platoons, by id of their leader
+    std::map<int, Reservation> reservations;
+
+    // duration of a slot and number of slots in a beaconing interval
+    SimTime slotDuration;
+    int nSlots;
+    // reservations not heard for this long are forgotten
+    SimTime reservationTimeout;
+
+    // reservation of our platoon. for followers, as heard from the leader
+    int slotOwner;
+    int slotOffset;
+    int slotCount;
+
+    // first slot of our block, recorded every time it moves
+    cOutVector slotOffsetOut;
+
+public:
+    CoordinatedSlottedBeaconing();
+    virtual ~CoordinatedSlottedBeaconing();
+
+    virtual void initialize(int stage) override;
+};
+
+} // namespace plexe
+
+#endif /* COORDINATEDSLOTTEDBEACONING_H_ */
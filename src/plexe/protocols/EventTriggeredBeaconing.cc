@@ -0,0 +1,105 @@
+//
+// Copyright (C) 2021 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+
+#include "EventTriggeredBeaconing.h"
+
+#include "plexe/utilities/DeadReckoning.h"
+
+#include <cmath>
+
+namespace plexe {
+
+Define_Module(EventTriggeredBeaconing)
+
+void EventTriggeredBeaconing::initialize(int stage)
+{
+    BaseProtocol::initialize(stage);
+
+    if (stage == 0) {
+        checkInterval = SimTime(par("checkInterval").doubleValue());
+        ASSERT2(checkInterval > 0, "checkInterval must be positive");
+        maxSilence = SimTime(par("maxSilence").doubleValue());
+        speedThreshold = par("speedThreshold");
+        accelerationThreshold = par("accelerationThreshold");
+
+        lastSentTime = SimTime(-1);
+        nextPeriodicBeacon = SimTime(0);
+        sentBeacons = 0;
+        suppressedBeacons = 0;
+
+        // random start time
+        SimTime beginTime = SimTime(uniform(0.001, beaconingInterval));
+        scheduleAt(simTime() + beaconingInterval + beginTime, sendBeacon);
+    }
+}
+
+void EventTriggeredBeaconing::handleSelfMsg(cMessage* msg)
+{
+
+    BaseProtocol::handleSelfMsg(msg);
+
+    if (msg == sendBeacon) {
+        VEHICLE_DATA data;
+        plexeTraciVehicle->getVehicleData(&data);
+        if (lastSentTime < 0 || simTime() - lastSentTime >= maxSilence || hasDeviated(data)) {
+            sendTo(createBeacon(-1, data).release(), PlexeRadioInterfaces::ALL);
+            lastSent = data;
+            lastSentTime = simTime();
+            nextPeriodicBeacon = simTime() + beaconingInterval;
+            sentBeacons++;
+        }
+        else if (simTime() >= nextPeriodicBeacon) {
+            // a beaconingInterval deadline passed without sending
+            suppressedBeacons++;
+            nextPeriodicBeacon += beaconingInterval;
+        }
+        scheduleAt(simTime() + checkInterval, sendBeacon);
+    }
+}
+
+bool EventTriggeredBeaconing::hasDeviated(const VEHICLE_DATA& data) const
+{
+    // receivers extrapolate with the acceleration in the last beacon, and
+    // the controller acceleration is assumed to be constant
+    VEHICLE_DATA predicted;
+    extrapolateVehicleData(lastSent, data.time, lastSent.acceleration, predicted);
+    if (std::abs(data.speed - predicted.speed) > speedThreshold) return true;
+    if (std::abs(data.acceleration - predicted.acceleration) > accelerationThreshold) return true;
+    if (std::abs(data.u - predicted.u) > accelerationThreshold) return true;
+    return false;
+}
+
+void EventTriggeredBeaconing::finish()
+{
+    recordScalar("sentBeacons", sentBeacons);
+    recordScalar("suppressedBeacons", suppressedBeacons);
+    BaseProtocol::finish();
+}
+
+EventTriggeredBeaconing::EventTriggeredBeaconing()
+{
+}
+
+EventTriggeredBeaconing::~EventTriggeredBeaconing()
+{
+}
+
+} // namespace plexe
@@ -0,0 +1,72 @@
+//
+// Copyright (C) 2021 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+
+#ifndef EVENTTRIGGEREDBEACONING_H_
+#define EVENTTRIGGEREDBEACONING_H_
+
+#include "BaseProtocol.h"
+
+namespace plexe {
+
+/**
+ * Beaconing protocol sending a beacon only when the state of the vehicle
+ * deviates from what receivers would extrapolate from the last beacon sent
+ * (constant acceleration), or when no beacon has been sent for too long.
+ * The state is checked every checkInterval, which is the shortest interval
+ * between two beacons
+ */
+class EventTriggeredBeaconing : public BaseProtocol {
+protected:
+    virtual void handleSelfMsg(cMessage* msg) override;
+
+    // returns whether receivers can no longer extrapolate our current data from the last beacon
+    bool hasDeviated(const VEHICLE_DATA& data) const;
+
+    // interval between two checks of the vehicle state
+    SimTime checkInterval;
+    // maximum time without sending a beacon
+    SimTime maxSilence;
+    // maximum tolerated error between predicted and actual data
+    double speedThreshold;
+    double accelerationThreshold;
+
+    // data sent in the last beacon and time it was sent at
+    VEHICLE_DATA lastSent;
+    SimTime lastSentTime;
+    // time at which a periodic protocol would send its next beacon
+    SimTime nextPeriodicBeacon;
+
+    // number of beacons sent, and of beacons a periodic protocol with the
+    // same beaconingInterval would have sent that we suppressed
+    long sentBeacons;
+    long suppressedBeacons;
+
+public:
+    EventTriggeredBeaconing();
+    virtual ~EventTriggeredBeaconing();
+
+    virtual void initialize(int stage) override;
+    virtual void finish() override;
+};
+
+} // namespace plexe
+
+#endif /* EVENTTRIGGEREDBEACONING_H_ */
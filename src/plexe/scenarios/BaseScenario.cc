@@ -142,22 +142,22 @@ void BaseScenario::handleSelfMsg(cMessage* msg)
 void BaseScenario::initializeControllers()
 {
     // engine lag
-    traciVehicle->setParameter(CC_PAR_ENGINE_TAU, engineTau);
-    traciVehicle->setParameter(CC_PAR_UMIN, uMin);
-    traciVehicle->setParameter(CC_PAR_UMAX, uMax);
+    plexeTraciVehicle->setParameter(CC_PAR_ENGINE_TAU, engineTau);
+    plexeTraciVehicle->setParameter(CC_PAR_UMIN, uMin);
+    plexeTraciVehicle->setParameter(CC_PAR_UMAX, uMax);
     // PATH's CACC parameters
     plexeTraciVehicle->setPathCACCParameters(caccOmegaN, caccXi, caccC1, caccSpacing);
     // Ploeg's parameters
     plexeTraciVehicle->setPloegCACCParameters(ploegKp, ploegKd, ploegH);
     // flatbed's parameters
-    traciVehicle->setParameter(CC_PAR_FLATBED_KA, flatbedKa);
-    traciVehicle->setParameter(CC_PAR_FLATBED_KV, flatbedKv);
-    traciVehicle->setParameter(CC_PAR_FLATBED_KP, flatbedKp);
-    traciVehicle->setParameter(CC_PAR_FLATBED_H, flatbedH);
-    traciVehicle->setParameter(CC_PAR_FLATBED_D, flatbedD);
+    plexeTraciVehicle->setParameter(CC_PAR_FLATBED_KA, flatbedKa);
+    plexeTraciVehicle->setParameter(CC_PAR_FLATBED_KV, flatbedKv);
+    plexeTraciVehicle->setParameter(CC_PAR_FLATBED_KP, flatbedKp);
+    plexeTraciVehicle->setParameter(CC_PAR_FLATBED_H, flatbedH);
+    plexeTraciVehicle->setParameter(CC_PAR_FLATBED_D, flatbedD);
     // consensus parameters
-    traciVehicle->setParameter(CC_PAR_VEHICLE_POSITION, positionHelper->getPosition());
-    traciVehicle->setParameter(CC_PAR_PLATOON_SIZE, positionHelper->getPlatoonSize());
+    plexeTraciVehicle->setParameter(CC_PAR_VEHICLE_POSITION, positionHelper->getPosition());
+    plexeTraciVehicle->setParameter(CC_PAR_PLATOON_SIZE, positionHelper->getPlatoonSize());
     // use of controller acceleration
     plexeTraciVehicle->useControllerAcceleration(useControllerAcceleration);
 
@@ -182,11 +182,11 @@ void BaseScenario::initializeControllers()
         int engineModel = CC_ENGINE_MODEL_REALISTIC;
         // the order is important
         // 1. let sumo instantiate the realistic engine model
-        traciVehicle->setParameter(CC_PAR_VEHICLE_ENGINE_MODEL, engineModel);
+        plexeTraciVehicle->setParameter(CC_PAR_VEHICLE_ENGINE_MODEL, engineModel);
         // 2. tell the realistic engine model the location of the parameters file
-        traciVehicle->setParameter(CC_PAR_VEHICLES_FILE, vehicleFile);
+        plexeTraciVehicle->setParameter(CC_PAR_VEHICLES_FILE, vehicleFile);
         // 3. tell the realistic engine model which vehicle (in the specified parameters file) to use
-        traciVehicle->setParameter(CC_PAR_VEHICLE_MODEL, vehicleType);
+        plexeTraciVehicle->setParameter(CC_PAR_VEHICLE_MODEL, vehicleType);
     }
 }
 
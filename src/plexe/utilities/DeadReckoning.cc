@@ -0,0 +1,61 @@
+//
+// Copyright (C) 2021 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+
+#include "plexe/utilities/DeadReckoning.h"
+
+#include <cmath>
+
+namespace plexe {
+
+void extrapolateVehicleData(const VEHICLE_DATA& data, double time, double acceleration, VEHICLE_DATA& predicted)
+{
+    double dt = time - data.time;
+    double speed = data.speed;
+    double speedX = data.speedX;
+    double speedY = data.speedY;
+    double positionX = data.positionX;
+    double positionY = data.positionY;
+
+    // a decelerating vehicle stops after speed / -acceleration seconds
+    double movingTime = dt;
+    if (acceleration < 0 && speed + acceleration * dt < 0) movingTime = speed > 0 ? -speed / acceleration : 0;
+    double newSpeed = speed + acceleration * movingTime;
+    double distance = speed * movingTime + 0.5 * acceleration * movingTime * movingTime;
+
+    if (speed > 0) {
+        // move along the direction of the velocity vector
+        positionX += distance * speedX / speed;
+        positionY += distance * speedY / speed;
+        speedX *= newSpeed / speed;
+        speedY *= newSpeed / speed;
+    }
+
+    predicted = data;
+    predicted.speed = newSpeed;
+    predicted.acceleration = newSpeed > 0 ? data.acceleration : 0;
+    predicted.positionX = positionX;
+    predicted.positionY = positionY;
+    predicted.speedX = speedX;
+    predicted.speedY = speedY;
+    predicted.time = time;
+}
+
+} // namespace plexe
@@ -0,0 +1,44 @@
+//
+// Copyright (C) 2021 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+
+#ifndef DEADRECKONING_H_
+#define DEADRECKONING_H_
+
+#include "plexe/CC_Const.h"
+
+namespace plexe {
+
+/**
+ * Extrapolates the data of a vehicle to a later time, assuming it keeps
+ * moving in the same direction with constant acceleration. The vehicle is
+ * assumed to stop rather than to drive backwards
+ *
+ * \param data the last known data of the vehicle
+ * \param time the time to extrapolate to, in the same time base as data.time
+ * \param acceleration the acceleration to extrapolate with, e.g., the
+ * actual acceleration or the one computed by the controller
+ * \param predicted filled with the extrapolated data. it can be the same as data
+ */
+void extrapolateVehicleData(const VEHICLE_DATA& data, double time, double acceleration, VEHICLE_DATA& predicted);
+
+} // namespace plexe
+
+#endif /* DEADRECKONING_H_ */
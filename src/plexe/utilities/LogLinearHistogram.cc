@@ -0,0 +1,93 @@
+//
+// Copyright (C) 2021 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+
+#include "plexe/utilities/LogLinearHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace plexe {
+
+LogLinearHistogram::LogLinearHistogram(int subBuckets, double minValue)
+    : subBuckets(subBuckets)
+    , minValue(minValue)
+{
+    clear();
+}
+
+void LogLinearHistogram::collect(double value)
+{
+    buckets[getBucket(value)]++;
+    if (count == 0 || value > max) max = value;
+    count++;
+    sum += value;
+}
+
+void LogLinearHistogram::merge(const LogLinearHistogram& other)
+{
+    for (const auto& bucket : other.buckets)
+        buckets[bucket.first] += bucket.second;
+    if (other.count > 0 && (count == 0 || other.max > max)) max = other.max;
+    count += other.count;
+    sum += other.sum;
+}
+
+void LogLinearHistogram::clear()
+{
+    buckets.clear();
+    count = 0;
+    sum = 0;
+    max = 0;
+}
+
+double LogLinearHistogram::getQuantile(double q) const
+{
+    if (count == 0) return 0;
+    // rank of the requested value, starting from 1
+    uint64_t rank = std::max<uint64_t>(1, (uint64_t) std::ceil(q * count));
+    uint64_t seen = 0;
+    for (const auto& bucket : buckets) {
+        seen += bucket.second;
+        if (seen >= rank) return std::min(getBucketValue(bucket.first), max);
+    }
+    return max;
+}
+
+int LogLinearHistogram::getBucket(double value) const
+{
+    if (value < minValue) return 0;
+    // value = mantissa * 2^exponent with mantissa in [0.5, 1)
+    int exponent;
+    double mantissa = std::frexp(value / minValue, &exponent);
+    int sub = std::min((int) ((mantissa - 0.5) * 2 * subBuckets), subBuckets - 1);
+    return 1 + (exponent - 1) * subBuckets + sub;
+}
+
+double LogLinearHistogram::getBucketValue(int bucket) const
+{
+    if (bucket == 0) return 0;
+    int exponent = (bucket - 1) / subBuckets + 1;
+    int sub = (bucket - 1) % subBuckets;
+    double mantissa = 0.5 + (sub + 0.5) / (2 * subBuckets);
+    return std::ldexp(mantissa, exponent) * minValue;
+}
+
+} // namespace plexe
@@ -0,0 +1,76 @@
+//
+// Copyright (C) 2021 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+
+#ifndef LOGLINEARHISTOGRAM_H_
+#define LOGLINEARHISTOGRAM_H_
+
+#include <cstdint>
+#include <map>
+
+namespace plexe {
+
+/**
+ * Histogram of non-negative values with bounded relative error, to compute
+ * quantiles of long streams in constant memory. Each power of two is split
+ * into a fixed number of linear buckets, so a quantile is within
+ * 1 / subBuckets of the true value. Values below minValue are counted as 0
+ */
+class LogLinearHistogram {
+public:
+    LogLinearHistogram(int subBuckets = 64, double minValue = 1e-9);
+
+    void collect(double value);
+    // adds all the values collected by another histogram with the same configuration
+    void merge(const LogLinearHistogram& other);
+    void clear();
+
+    // returns the value below which the given fraction (in [0, 1]) of the values fall
+    double getQuantile(double q) const;
+    uint64_t getCount() const
+    {
+        return count;
+    }
+    double getMax() const
+    {
+        return max;
+    }
+    double getMean() const
+    {
+        return count > 0 ? sum / count : 0;
+    }
+
+private:
+    int getBucket(double value) const;
+    // returns the center of a bucket
+    double getBucketValue(int bucket) const;
+
+    int subBuckets;
+    double minValue;
+    // number of values in each bucket. bucket 0 holds the values below minValue
+    std::map<int, uint64_t> buckets;
+    uint64_t count;
+    double sum;
+    double max;
+};
+
+} // namespace plexe
+
+#endif /* LOGLINEARHISTOGRAM_H_ */
@@ -0,0 +1,187 @@
+//
+// Copyright (C) 2021 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "plexe/utilities/TimerService.h"
+
+#include <algorithm>
+
+using namespace omnetpp;
+
+namespace plexe {
+
+TimerService::TimerService(cSimpleModule* owner, simtime_t resolution, int slots)
+    : owner(owner)
+    , resolution(resolution)
+    , wheel(slots, -1)
+    , armedTimers(0)
+    , scheduledTick(-1)
+    , tick(new cMessage("timerServiceTick"))
+    , ticks(0)
+{
+    ASSERT2(resolution > 0 && slots > 0, "invalid timer wheel configuration");
+}
+
+TimerService::~TimerService()
+{
+    owner->cancelAndDelete(tick);
+}
+
+int TimerService::registerTimer(const std::string& name, std::function<void()> callback)
+{
+    Timer timer;
+    timer.name = name;
+    timer.callback = callback;
+    timer.expiration = 0;
+    timer.slot = -1;
+    timer.prev = -1;
+    timer.next = -1;
+    timer.armed = 0;
+    timer.rearmed = 0;
+    timer.cancelled = 0;
+    timer.fired = 0;
+    timers.push_back(timer);
+    return timers.size() - 1;
+}
+
+void TimerService::arm(int id, simtime_t delay)
+{
+    Timer& timer = timers[id];
+    if (timer.slot >= 0) {
+        unlink(id);
+        timer.rearmed++;
+    }
+    else {
+        timer.armed++;
+    }
+    // fire at the first tick at or after the expiration time, but never in the current one
+    int64_t now = simTime().raw();
+    int64_t expiration = (now + delay.raw() + resolution.raw() - 1) / resolution.raw();
+    timer.expiration = std::max(expiration, now / resolution.raw() + 1);
+    link(id);
+    scheduleTick(timer.expiration);
+}
+
+void TimerService::cancel(int id)
+{
+    Timer& timer = timers[id];
+    if (timer.slot == -2) {
+        // expired in the tick being processed, but not fired yet
+        timer.slot = -1;
+        timer.cancelled++;
+        return;
+    }
+    if (timer.slot < 0) return;
+    unlink(id);
+    timer.cancelled++;
+    if (armedTimers == 0 && scheduledTick >= 0) {
+        owner->cancelEvent(tick);
+        scheduledTick = -1;
+    }
+}
+
+bool TimerService::handleMessage(cMessage* msg)
+{
+    if (msg != tick) return false;
+
+    ticks++;
+    int64_t current = scheduledTick;
+    scheduledTick = -1;
+
+    // collect the expired timers first, as callbacks might arm or cancel timers of the same slot
+    expired.clear();
+    int slot = current % wheel.size();
+    for (int id = wheel[slot]; id >= 0;) {
+        int next = timers[id].next;
+        if (timers[id].expiration <= current) {
+            unlink(id);
+            timers[id].slot = -2;
+            expired.push_back(id);
+        }
+        id = next;
+    }
+    for (int id : expired) {
+        // skip timers cancelled or re-armed by the callback of another timer
+        if (timers[id].slot != -2) continue;
+        timers[id].slot = -1;
+        timers[id].fired++;
+        timers[id].callback();
+    }
+
+    scheduleNextTick();
+    return true;
+}
+
+void TimerService::recordStatistics() const
+{
+    for (const Timer& timer : timers) {
+        owner->recordScalar((timer.name + "Armed").c_str(), timer.armed);
+        owner->recordScalar((timer.name + "Rearmed").c_str(), timer.rearmed);
+        owner->recordScalar((timer.name + "Cancelled").c_str(), timer.cancelled);
+        owner->recordScalar((timer.name + "Fired").c_str(), timer.fired);
+    }
+    owner->recordScalar("timerServiceTicks", ticks);
+}
+
+void TimerService::link(int id)
+{
+    Timer& timer = timers[id];
+    timer.slot = timer.expiration % wheel.size();
+    timer.prev = -1;
+    timer.next = wheel[timer.slot];
+    if (timer.next >= 0) timers[timer.next].prev = id;
+    wheel[timer.slot] = id;
+    armedTimers++;
+}
+
+void TimerService::unlink(int id)
+{
+    Timer& timer = timers[id];
+    if (timer.prev >= 0)
+        timers[timer.prev].next = timer.next;
+    else
+        wheel[timer.slot] = timer.next;
+    if (timer.next >= 0) timers[timer.next].prev = timer.prev;
+    timer.slot = -1;
+    timer.prev = -1;
+    timer.next = -1;
+    armedTimers--;
+}
+
+void TimerService::scheduleNextTick()
+{
+    if (armedTimers == 0) return;
+    int64_t now = simTime().raw() / resolution.raw();
+    for (int64_t t = now + 1; t <= now + (int64_t) wheel.size(); t++) {
+        if (wheel[t % wheel.size()] >= 0) {
+            scheduleTick(t);
+            return;
+        }
+    }
+}
+
+void TimerService::scheduleTick(int64_t t)
+{
+    if (scheduledTick >= 0 && scheduledTick <= t) return;
+    if (scheduledTick >= 0) owner->cancelEvent(tick);
+    scheduledTick = t;
+    owner->scheduleAt(SimTime::fromRaw(t * resolution.raw()), tick);
+}
+
+} // namespace plexe
@@ -0,0 +1,138 @@
+//
+// Copyright (C) 2021 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#ifndef TIMERSERVICE_H_
+#define TIMERSERVICE_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "plexe/plexe.h"
+
+namespace plexe {
+
+/**
+ * Named timers of a module, multiplexed on a single self message through a
+ * hashed timer wheel. Time is divided into ticks of a fixed resolution, and
+ * each timer is linked into the wheel slot of the tick it expires in, so
+ * arming, re-arming, and cancelling a timer take constant time and allocate
+ * no memory. The self message is only scheduled for ticks whose slot holds
+ * an armed timer, so the number of scheduled events does not depend on the
+ * number of timers. Timers fire at the first tick after their expiration
+ * time.
+ *
+ * Timers are registered once (e.g., in the constructor of a maneuver) and
+ * then referred to by the returned id. The owner module must pass its self
+ * messages to handleMessage().
+ */
+class TimerService {
+public:
+    /**
+     * @param owner module scheduling the self message
+     * @param resolution duration of a tick
+     * @param slots number of slots of the wheel. timers expiring more than
+     * slots ticks ahead share their slot with closer ones
+     */
+    TimerService(omnetpp::cSimpleModule* owner, omnetpp::simtime_t resolution, int slots);
+    ~TimerService();
+
+    /**
+     * Registers a timer
+     *
+     * @param name name of the timer, used for the statistics
+     * @param callback function invoked when the timer fires
+     * @return the id of the timer
+     */
+    int registerTimer(const std::string& name, std::function<void()> callback);
+
+    /**
+     * Arms a timer to fire after the given delay. If the timer is already
+     * armed, its expiration time is replaced
+     */
+    void arm(int timer, omnetpp::simtime_t delay);
+
+    /**
+     * Disarms a timer. Does nothing if the timer is not armed
+     */
+    void cancel(int timer);
+
+    bool isArmed(int timer) const
+    {
+        return timers[timer].slot >= 0;
+    }
+
+    /**
+     * Processes a self message of the owner
+     *
+     * @return true if the message belongs to the timer service
+     */
+    bool handleMessage(omnetpp::cMessage* msg);
+
+    /**
+     * Records the number of times each timer has been armed, re-armed,
+     * cancelled, and fired as scalars of the owner module, together with the
+     * number of self messages used
+     */
+    void recordStatistics() const;
+
+private:
+    struct Timer {
+        std::string name;
+        std::function<void()> callback;
+        // tick the timer expires at
+        int64_t expiration;
+        // slot the timer is linked into, -1 if not armed
+        int slot;
+        // previous and next timers in the slot, -1 at the ends
+        int prev;
+        int next;
+        // statistics
+        uint64_t armed;
+        uint64_t rearmed;
+        uint64_t cancelled;
+        uint64_t fired;
+    };
+
+    void link(int timer);
+    void unlink(int timer);
+    // schedules the self message for the first tick after the current one with an armed timer
+    void scheduleNextTick();
+    // schedules the self message for the given tick, if it is earlier than the scheduled one
+    void scheduleTick(int64_t tick);
+
+    omnetpp::cSimpleModule* owner;
+    omnetpp::simtime_t resolution;
+    std::vector<Timer> timers;
+    // first timer of each slot, -1 if the slot is empty
+    std::vector<int> wheel;
+    // timers expired in the tick being processed
+    std::vector<int> expired;
+    int armedTimers;
+    // tick the self message is scheduled for, -1 if not scheduled
+    int64_t scheduledTick;
+    omnetpp::cMessage* tick;
+    uint64_t ticks;
+};
+
+} // namespace plexe
+
+#endif /* TIMERSERVICE_H_ */
@@ -0,0 +1,122 @@
+//
+// Copyright (C) 2021 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "catch2/catch.hpp"
+
+#include "plexe/utilities/LogLinearHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using plexe::LogLinearHistogram;
+
+namespace {
+
+// exact quantile with the same rank definition used by the histogram
+double exactQuantile(std::vector<double> values, double q)
+{
+    std::sort(values.begin(), values.end());
+    size_t rank = std::max<size_t>(1, (size_t) std::ceil(q * values.size()));
+    return values[rank - 1];
+}
+
+} // namespace
+
+TEST_CASE("LogLinearHistogram", "[statistics]")
+{
+    const double quantiles[] = {0.01, 0.1, 0.5, 0.9, 0.95, 0.99, 1};
+
+    SECTION("quantiles are within 1 / subBuckets of the exact ones")
+    {
+        for (int subBuckets : {8, 64}) {
+            std::mt19937 rng(42);
+            // delays spanning several orders of magnitude
+            std::lognormal_distribution<double> distribution(std::log(0.1), 1.5);
+            LogLinearHistogram histogram(subBuckets);
+            std::vector<double> values;
+            for (int i = 0; i < 10000; i++) {
+                double v = distribution(rng);
+                values.push_back(v);
+                histogram.collect(v);
+            }
+            REQUIRE(histogram.getCount() == values.size());
+            for (double q : quantiles) {
+                double exact = exactQuantile(values, q);
+                CHECK(std::abs(histogram.getQuantile(q) - exact) <= exact / subBuckets);
+            }
+            CHECK(histogram.getQuantile(1) == *std::max_element(values.begin(), values.end()));
+        }
+    }
+
+    SECTION("merging is the same as collecting all the values")
+    {
+        std::mt19937 rng(7);
+        std::exponential_distribution<double> distribution(10);
+        LogLinearHistogram all, first, second;
+        for (int i = 0; i < 5000; i++) {
+            double v = distribution(rng);
+            all.collect(v);
+            (i % 3 == 0 ? first : second).collect(v);
+        }
+        first.merge(second);
+        REQUIRE(first.getCount() == all.getCount());
+        CHECK(first.getMax() == all.getMax());
+        CHECK(first.getMean() == Approx(all.getMean()));
+        for (double q : quantiles) CHECK(first.getQuantile(q) == all.getQuantile(q));
+    }
+
+    SECTION("merging into an empty histogram keeps the maximum")
+    {
+        LogLinearHistogram empty, other;
+        other.collect(0.5);
+        other.collect(2);
+        empty.merge(other);
+        CHECK(empty.getCount() == 2);
+        CHECK(empty.getMax() == 2);
+        other.merge(LogLinearHistogram());
+        CHECK(other.getCount() == 2);
+        CHECK(other.getMax() == 2);
+    }
+
+    SECTION("values below minValue are counted as 0")
+    {
+        LogLinearHistogram histogram(64, 1e-3);
+        histogram.collect(0);
+        histogram.collect(1e-4);
+        histogram.collect(5e-4);
+        histogram.collect(1);
+        CHECK(histogram.getCount() == 4);
+        CHECK(histogram.getQuantile(0.25) == 0);
+        CHECK(histogram.getQuantile(0.75) == 0);
+        CHECK(std::abs(histogram.getQuantile(1) - 1) <= 1.0 / 64);
+        // the mean is computed on the actual values
+        CHECK(histogram.getMean() == Approx((1e-4 + 5e-4 + 1) / 4));
+    }
+
+    SECTION("an empty histogram returns 0")
+    {
+        LogLinearHistogram histogram;
+        CHECK(histogram.getCount() == 0);
+        CHECK(histogram.getQuantile(0.5) == 0);
+        CHECK(histogram.getMean() == 0);
+    }
+}
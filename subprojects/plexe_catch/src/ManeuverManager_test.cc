@@ -0,0 +1,108 @@
+//
+// Copyright (C) 2021 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "catch2/catch.hpp"
+
+#include "plexe/maneuver/ManeuverManager.h"
+
+#include "plexe/plexe.h"
+
+using plexe::Maneuver;
+using plexe::ManeuverManager;
+
+using LockMode = ManeuverManager::LockMode;
+
+TEST_CASE("ManeuverManager", "[maneuver]")
+{
+    // the manager only compares maneuver pointers, so they can refer to
+    // dummy objects
+    char maneuvers[2];
+    Maneuver* a = reinterpret_cast<Maneuver*>(&maneuvers[0]);
+    Maneuver* b = reinterpret_cast<Maneuver*>(&maneuvers[1]);
+    ManeuverManager manager;
+
+    SECTION("shared locks are compatible with each other only")
+    {
+        REQUIRE(manager.lock(a, ManeuverManager::LANE, LockMode::SHARED));
+        REQUIRE(manager.lock(b, ManeuverManager::LANE, LockMode::SHARED));
+        REQUIRE_FALSE(manager.canLock(nullptr, ManeuverManager::LANE, LockMode::EXCLUSIVE));
+        REQUIRE(manager.canLock(nullptr, ManeuverManager::LANE, LockMode::SHARED));
+
+        manager.unlock(b);
+        REQUIRE(manager.lock(b, ManeuverManager::FORMATION_TAIL, LockMode::EXCLUSIVE));
+        REQUIRE_FALSE(manager.canLock(a, ManeuverManager::FORMATION_TAIL, LockMode::SHARED));
+        REQUIRE_FALSE(manager.lock(a, ManeuverManager::FORMATION_TAIL, LockMode::EXCLUSIVE));
+        // different resources do not interfere without conflict rules
+        REQUIRE(manager.canLock(nullptr, ManeuverManager::LEADER_ROLE, LockMode::EXCLUSIVE));
+    }
+
+    SECTION("a shared lock can be upgraded if nobody else holds it")
+    {
+        REQUIRE(manager.lock(a, ManeuverManager::LANE | ManeuverManager::LEADER_ROLE, LockMode::SHARED));
+        REQUIRE(manager.canLock(a, ManeuverManager::LANE, LockMode::EXCLUSIVE));
+        REQUIRE(manager.lock(b, ManeuverManager::LEADER_ROLE, LockMode::SHARED));
+        REQUIRE(manager.lock(a, ManeuverManager::LANE, LockMode::EXCLUSIVE));
+        REQUIRE_FALSE(manager.canLock(b, ManeuverManager::LANE, LockMode::SHARED));
+
+        // the role is still shared, so it cannot be upgraded by either
+        REQUIRE_FALSE(manager.lock(a, ManeuverManager::LEADER_ROLE, LockMode::EXCLUSIVE));
+        REQUIRE_FALSE(manager.lock(b, ManeuverManager::LEADER_ROLE, LockMode::EXCLUSIVE));
+        // a failed lock leaves the held ones untouched
+        REQUIRE(manager.canLock(b, ManeuverManager::LEADER_ROLE, LockMode::SHARED));
+        REQUIRE_FALSE(manager.canLock(b, ManeuverManager::LANE, LockMode::SHARED));
+    }
+
+    SECTION("conflict rules hold whatever the lock mode")
+    {
+        manager.parseConflicts("lane:tail role:tail");
+        REQUIRE(manager.lock(a, ManeuverManager::LANE, LockMode::SHARED));
+        REQUIRE_FALSE(manager.canLock(b, ManeuverManager::FORMATION_TAIL, LockMode::SHARED));
+        REQUIRE(manager.canLock(b, ManeuverManager::LEADER_ROLE, LockMode::EXCLUSIVE));
+        // a maneuver does not conflict with itself
+        REQUIRE(manager.lock(a, ManeuverManager::FORMATION_TAIL, LockMode::EXCLUSIVE));
+        REQUIRE_FALSE(manager.canLock(b, ManeuverManager::LEADER_ROLE, LockMode::SHARED));
+
+        REQUIRE_THROWS_AS(manager.parseConflicts("lane"), omnetpp::cRuntimeError);
+        REQUIRE_THROWS_AS(manager.parseConflicts("lane:speed"), omnetpp::cRuntimeError);
+        REQUIRE_NOTHROW(manager.parseConflicts(""));
+    }
+
+    SECTION("unlock releases all the locks of a maneuver")
+    {
+        REQUIRE_FALSE(manager.isInManeuver());
+        REQUIRE(manager.lock(a, ManeuverManager::LANE, LockMode::EXCLUSIVE));
+        REQUIRE(manager.lock(a, ManeuverManager::LEADER_ROLE, LockMode::SHARED));
+        REQUIRE(manager.lock(b, ManeuverManager::FORMATION_TAIL, LockMode::SHARED));
+        REQUIRE(manager.isActive(a));
+        REQUIRE(manager.getActiveManeuvers().size() == 2);
+
+        manager.unlock(a);
+        REQUIRE_FALSE(manager.isActive(a));
+        REQUIRE(manager.isActive(b));
+        REQUIRE(manager.canLock(nullptr, ManeuverManager::LANE | ManeuverManager::LEADER_ROLE, LockMode::EXCLUSIVE));
+
+        manager.unlock(b);
+        REQUIRE_FALSE(manager.isInManeuver());
+        REQUIRE(manager.getActiveManeuvers().empty());
+        // unlocking a maneuver without locks is harmless
+        manager.unlock(b);
+        REQUIRE_FALSE(manager.isInManeuver());
+    }
+}
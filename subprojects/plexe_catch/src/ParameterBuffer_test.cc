@@ -0,0 +1,178 @@
+//
+// Copyright (C) 2018-2021 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "catch2/catch.hpp"
+
+#include "plexe/mobility/ParameterBuffer.h"
+
+#include "veins/modules/mobility/traci/ParBuffer.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+using plexe::traci::ParameterBuffer;
+using veins::ParBuffer;
+
+namespace {
+
+const double values[] = {0, -0.0, 1, -1, 0.1, 27.7777777, -3.14159265358979, 1234.5678, 123456.789, 1e-7, 6.02e23, -2.5e-300, std::numeric_limits<double>::max(), std::numeric_limits<double>::infinity()};
+
+// vehicle data as sent by setVehicleData, in the same order
+void encodeVehicleData(ParameterBuffer& buf, int i)
+{
+    buf << i << 27.7 + i << -0.5 * i << 1000.25 + 10 * i << 3.2 << 12.34 + i << 4.0 << 0.05 * i << 27.7 << 0.01 << 1.5707963;
+}
+
+void encodeVehicleData(ParBuffer& buf, int i)
+{
+    buf << i << 27.7 + i << -0.5 * i << 1000.25 + 10 * i << 3.2 << 12.34 + i << 4.0 << 0.05 * i << 27.7 << 0.01 << 1.5707963;
+}
+
+// decodes vehicle data as read by getVehicleData, returning all the fields
+template <typename Buffer>
+std::vector<double> decodeVehicleData(Buffer& buf)
+{
+    int index = -1;
+    double fields[10];
+    std::fill(fields, fields + 10, -1);
+    buf >> index;
+    for (double& field : fields) buf >> field;
+    std::vector<double> decoded(1, index);
+    decoded.insert(decoded.end(), fields, fields + 10);
+    return decoded;
+}
+
+} // namespace
+
+TEST_CASE("ParameterBuffer", "[traci]")
+{
+    SECTION("doubles are encoded like veins::ParBuffer")
+    {
+        for (double v : values) {
+            ParBuffer reference;
+            reference << v;
+            ParameterBuffer buf;
+            buf << v;
+            REQUIRE(buf.str() == reference.str());
+        }
+    }
+
+    SECTION("mixed values are encoded like veins::ParBuffer")
+    {
+        ParBuffer reference;
+        ParameterBuffer buf;
+        reference << std::string("ccvd") << 3 << -42 << 0.25 << std::string("v.1") << 1e10;
+        buf << std::string("ccvd") << 3 << -42 << 0.25 << "v.1" << 1e10;
+        REQUIRE(buf.str() == reference.str());
+    }
+
+    SECTION("encoding and decoding round trips")
+    {
+        ParameterBuffer buf;
+        encodeVehicleData(buf, 5);
+        ParBuffer reference;
+        encodeVehicleData(reference, 5);
+        REQUIRE(buf.str() == reference.str());
+
+        buf.set(buf.str());
+        std::vector<double> decoded = decodeVehicleData(buf);
+        ParBuffer refBuf(reference.str());
+        std::vector<double> refDecoded = decodeVehicleData(refBuf);
+        REQUIRE(decoded == refDecoded);
+        REQUIRE(decoded[0] == 5);
+        REQUIRE(buf.eof());
+    }
+
+    SECTION("leading blanks and plus signs are decoded like veins::ParBuffer")
+    {
+        // doubles and ints alternate. "+-1" and "+" cannot be parsed
+        const std::string encoded = " 1.5:  +2:+3.25:\t-4:+-1: +7:+:+8:1e+3:-0:+0.5x";
+        ParameterBuffer buf;
+        buf.set(encoded);
+        ParBuffer reference(encoded);
+        for (int i = 0; i < 5; i++) {
+            double d = -1, refD = -1;
+            int n = -1, refN = -1;
+            buf >> d >> n;
+            reference >> refD >> refN;
+            REQUIRE(d == refD);
+            REQUIRE(n == refN);
+        }
+        double d = -1, refD = -1;
+        buf >> d;
+        reference >> refD;
+        REQUIRE(d == refD);
+        REQUIRE(d == 0.5);
+        REQUIRE(buf.eof());
+    }
+
+    SECTION("empty or missing fields leave values untouched")
+    {
+        ParameterBuffer buf;
+        buf.set("1::2");
+        int a = 0, b = 7, c = 0, d = 9;
+        buf >> a >> b >> c >> d;
+        REQUIRE(a == 1);
+        REQUIRE(b == 7);
+        REQUIRE(c == 2);
+        REQUIRE(d == 9);
+        REQUIRE(buf.eof());
+    }
+
+    SECTION("clear keeps the buffer reusable")
+    {
+        ParameterBuffer buf;
+        buf << 1.5 << 2;
+        buf.clear();
+        buf << 3;
+        REQUIRE(buf.str() == "3");
+    }
+}
+
+TEST_CASE("ParameterBuffer performance", "[.][benchmark]")
+{
+    const int iterations = 100000;
+    size_t sink = 0;
+
+    // decode every field, as the TraCI client does with a vehicle data reply
+    BENCHMARK("veins::ParBuffer encode and decode")
+    {
+        for (int i = 0; i < iterations; i++) {
+            ParBuffer out;
+            encodeVehicleData(out, i % 8);
+            ParBuffer in(out.str());
+            sink += (size_t) decodeVehicleData(in)[0];
+        }
+    }
+
+    BENCHMARK("ParameterBuffer encode and decode")
+    {
+        ParameterBuffer buf;
+        for (int i = 0; i < iterations; i++) {
+            buf.clear();
+            encodeVehicleData(buf, i % 8);
+            buf.set(buf.str());
+            sink += (size_t) decodeVehicleData(buf)[0];
+        }
+    }
+
+    REQUIRE(sink > 0);
+}